@@ -6,6 +6,9 @@
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "GameFramework/Actor.h"
 #include "BuildableManager.h"
+#include "Characters/Components/TeamComponent.h"
+#include "EngineUtils.h"
+#include "Systems/GDKComponentRegistry.h"
 
 // Sets default values for this component's properties
 UBuildManagerComponent::UBuildManagerComponent()
@@ -13,6 +16,7 @@ UBuildManagerComponent::UBuildManagerComponent()
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 
 	isBuilding = false;
 	canBuild = false;
@@ -35,171 +39,215 @@ void UBuildManagerComponent::BeginPlay()
 }
 
 
-// Called every frame
+// Called every frame, only while building
 void UBuildManagerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	FRotator CameraRotation1 = playerCamera->GetComponentRotation();
-	FVector Start1 = playerCamera->GetComponentLocation() + (CameraRotation1.Vector() * 150.f);
+	// The wall is frozen while a release waits for its snap traces.
+	if (!isBuilding || playerCamera == nullptr || releasePending) {
+		return;
+	}
 
-	FVector end = Start1 + (CameraRotation1.Vector() * 20000.f);
+	FHitResult HitResult;
 
-	//GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Purple, FString::FromInt(end.X) + " " + FString::FromInt(end.Y) + " " + FString::FromInt(end.Z));
+	float LineTraceDistance = 1800.f;
+	float HeadOffset = 150.f;
 
-	if (isBuilding) {
+	FRotator CameraRotation = playerCamera->GetComponentRotation();
+	FVector Start = playerCamera->GetComponentLocation() + (CameraRotation.Vector() * HeadOffset);
 
-		FHitResult HitResult;
+	FVector End = Start + (CameraRotation.Vector() * LineTraceDistance);
 
-		float LineTraceDistance = 1800.f;
-		float HeadOffset = 150.f;
+	FCollisionQueryParams TraceParams(FName(TEXT("InteractTrace")), true, NULL);
+	TraceParams.bTraceComplex = true;
+	TraceParams.bReturnPhysicalMaterial = true;
 
-		FRotator CameraRotation = playerCamera->GetComponentRotation();
-		FVector Start = playerCamera->GetComponentLocation() + (CameraRotation.Vector() * HeadOffset);
+	bool bIsHit = GetWorld()->LineTraceSingleByChannel(
+		HitResult,      // FHitResult object that will be populated with hit info
+		Start,      // starting position
+		End,        // end position
+		ECC_Visibility,  // collision channel
+		TraceParams      // additional trace settings
+	);
 
-		FVector End = Start + (CameraRotation.Vector() * LineTraceDistance);
+	currentTrace = HitResult.ImpactPoint;
 
-		FCollisionQueryParams TraceParams(FName(TEXT("InteractTrace")), true, NULL);
-		TraceParams.bTraceComplex = true;
-		TraceParams.bReturnPhysicalMaterial = true;
+	//DrawPreview
+	if (bIsHit&&previewMode){
+		FRotator ProperRotation = HitResult.GetComponent()->GetComponentRotation();
+		ProperRotation.SetComponentForAxis(EAxis::Z, CameraRotation.GetComponentForAxis(EAxis::Z));
 
-		bool bIsHit = GetWorld()->LineTraceSingleByChannel(
-			HitResult,      // FHitResult object that will be populated with hit info
-			Start,      // starting position
-			End,        // end position
-			ECC_Visibility,  // collision channel
-			TraceParams      // additional trace settings
-		);
+		FVector ProperLocation = HitResult.ImpactPoint;
 
-		currentTrace = HitResult.ImpactPoint;
+		if (currentBuildable == nullptr) {
+			currentBuildable = AcquirePreview(ProperLocation, ProperRotation);
+		}
+		else {
+			currentBuildable->SetActorLocationAndRotation(ProperLocation, ProperRotation);
+		}
+		canBuild = true;
+	}else if (bIsHit&&!previewMode){
+		FVector distanceCalculator = currentTrace - plantingPoint;
+		float distance = distanceCalculator.Size();
 
-		//DrawPreview
-		if (bIsHit&&previewMode){
-			// start to end, green, will lines always stay on, depth priority, thickness of line
-			//DrawDebugLine(GetWorld(), Start, HitResult.ImpactPoint, FColor::Green, false, 5.f, ECC_WorldStatic, 1.f);
+		//Get buildable lenght
+		float segmentLength = currentBuildable->GetComponentsBoundingBox(true,true).GetExtent().Size();
 
-			FRotator ProperRotation = HitResult.GetComponent()->GetComponentRotation();
-			ProperRotation.SetComponentForAxis(EAxis::Z, CameraRotation.GetComponentForAxis(EAxis::Z));
+		//Divide distance between planting point and currentTrace by buildable lenght
+		int amountOfCover = FMath::Min(int(distance / segmentLength) + 1, MaxSegmentsPerPlacement);
 
-			FVector ProperLocation = HitResult.ImpactPoint;
-			
+		//Take previews from the pool for new segments, and put extra ones back
+		for (int i = managedBuildables.Num(); i < amountOfCover; i++) {
+			FVector additiveVector = plantingPoint + (distanceCalculator.GetSafeNormal() * (segmentLength * i));
+			managedBuildables.Add(AcquirePreview(additiveVector, distanceCalculator.Rotation()));
+		}
+		while (managedBuildables.Num() > amountOfCover) {
+			ReleasePreview(managedBuildables.Pop(false));
+		}
 
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		//Snap to the ground again only once the end point has moved far enough
+		if (amountOfCover != lastSnapSegments || FVector::DistSquared(currentTrace, lastSnapEnd) > FMath::Square(SnapRefreshDistance)) {
+			lastSnapEnd = currentTrace;
+			lastSnapSegments = amountOfCover;
+			RequestGroundSnap(distanceCalculator, segmentLength);
+		}
+	}
+	else if (!bIsHit) {
+		canBuild = false;
+	}
+}
 
-			if (currentBuildable == nullptr) {
-				currentBuildable = GetWorld()->SpawnActor<ABuildable>(BuildableFortification, ProperLocation, ProperRotation, SpawnParams);
-				//DrawDebugBox(GetWorld(), ProperLocation, FVector(100, 100, 100), ProperRotation.Quaternion(), FColor::Red, false, 0, 0, 10);
-			}
-			else {
-				currentBuildable->SetActorLocationAndRotation(ProperLocation, ProperRotation);
-			}
-			canBuild = true;
-		}else if (bIsHit&&!previewMode){
-			FVector distanceCalculator = currentTrace - plantingPoint;
-			DrawDebugLine(GetWorld(), plantingPoint, currentTrace, FColor::Green, false, 5.f, ECC_WorldStatic, 1.f);
-			float distance = distanceCalculator.Size();
-
-			/*
-			FString TheFloatStr = FString::SanitizeFloat(distance);
-			GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, *TheFloatStr);
-			*/
-
-			//Get buildable lenght
-			FVector debugSize = currentBuildable->GetComponentsBoundingBox(true,true).GetExtent();
-			
-			//Divide distance between planting point and currentTrace by buildable lenght
-			int amountOfCover = (distance / debugSize.Size())+1;
-
-			//For each full distance spawn a buidable and add it to managedBuildables
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-			if (managedBuildables.Num() < amountOfCover) {
-				for (int i = managedBuildables.Num(); i < amountOfCover; i++) {
-					FVector additiveVector = plantingPoint + (distanceCalculator.GetSafeNormal() * (debugSize.Size() * i));
-					managedBuildables.Add(GetWorld()->SpawnActor<ABuildable>(BuildableFortification, additiveVector, distanceCalculator.Rotation(), SpawnParams));
-				}
-			}
+FCollisionQueryParams UBuildManagerComponent::MakeSnapTraceParams() const {
+	FCollisionQueryParams TraceParams(FName(TEXT("InteractTrace")), true, NULL);
+	TraceParams.bTraceComplex = true;
+	TraceParams.bReturnPhysicalMaterial = true;
+	return TraceParams;
+}
 
-			//Destroy extra buildables
-			if (managedBuildables.Num() > amountOfCover) {
-				for (int i = amountOfCover; i < managedBuildables.Num(); i++) {
-					managedBuildables[i]->Destroy();
-					managedBuildables.RemoveAt(i);
-				}
-			}
+void UBuildManagerComponent::RequestGroundSnap(const FVector& Direction, float SegmentLength) {
+	const uint32 Generation = ++snapGeneration;
+	snapYaw = Direction.Rotation().Yaw;
+	snappedSegments.Init(false, managedBuildables.Num());
+
+	const FCollisionQueryParams TraceParams = MakeSnapTraceParams();
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UBuildManagerComponent::OnSnapUpTraceCompleted, Generation);
+
+	for (int i = 0; i < managedBuildables.Num(); i++) {
+		//Shoot trace up, the segment index travels as the trace's user data
+		FVector additiveVector = plantingPoint + (Direction.GetSafeNormal() * (SegmentLength * i));
+		GetWorld()->AsyncLineTraceByChannel(
+			EAsyncTraceType::Single,
+			additiveVector,
+			additiveVector + (FVector(0, 0, 1) * 2000.f),
+			ECC_Visibility,
+			TraceParams,
+			FCollisionResponseParams::DefaultResponseParam,
+			&TraceDelegate,
+			static_cast<uint32>(i));
+	}
+}
 
-			//Fix rotation in real time
-			if (managedBuildables.Num() > 0) {
-				for (int i = 0; i < managedBuildables.Num(); i++) {
-					FVector additiveVector = plantingPoint + (distanceCalculator.GetSafeNormal() * (debugSize.Size() * i));
-
-					
-
-					//Shoot trace up
-					FVector endVectorCheck = additiveVector + (FVector(0, 0, 1) * 2000.f);
-					FHitResult HitResult1;
-
-					bool traceUp = GetWorld()->LineTraceSingleByChannel(
-						HitResult1,      // FHitResult object that will be populated with hit info
-						additiveVector,      // starting position
-						endVectorCheck,        // end position
-						ECC_Visibility,  // collision channel
-						TraceParams      // additional trace settings
-					);
-
-					//Shoot trace down
-					FVector endVectorCheck2 = additiveVector + (FVector(0, 0, -1) * 10000.f);
-					FHitResult HitResult2;
-					FVector startVector2;
-					if (traceUp) {
-						startVector2 = HitResult1.ImpactPoint;
-					}
-					else {
-						startVector2 = endVectorCheck;
-					}
-					bool traceDown = GetWorld()->LineTraceSingleByChannel(
-						HitResult2,      // FHitResult object that will be populated with hit info
-						startVector2,      // starting position
-						endVectorCheck2,        // end position
-						ECC_Visibility,  // collision channel
-						TraceParams      // additional trace settings
-					);
-
-					//If something is hit while going down, place the object there, else destroy it
-					FVector spawnVector;
-					if (traceDown) {
-						spawnVector = HitResult2.ImpactPoint;
-						FRotator finRotation = FRotator(spawnVector.Rotation().Pitch, distanceCalculator.Rotation().Yaw, spawnVector.Rotation().Roll);
-						managedBuildables[i]->SetActorLocationAndRotation(spawnVector, finRotation);
-					}
-					else {
-						managedBuildables[i]->Destroy();
-						managedBuildables.RemoveAt(i);
-					}
-				}
-			}
-		}
-		else if (!bIsHit) {
-			canBuild = false;
+void UBuildManagerComponent::OnSnapUpTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 Generation) {
+	if (Generation != snapGeneration || !managedBuildables.IsValidIndex(Datum.UserData)) {
+		return;
+	}
+
+	//Shoot trace down, from the ceiling if one was hit
+	const bool traceUp = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+	const FVector startVector2 = traceUp ? Datum.OutHits[0].ImpactPoint : Datum.End;
+
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UBuildManagerComponent::OnSnapDownTraceCompleted, Generation);
+	GetWorld()->AsyncLineTraceByChannel(
+		EAsyncTraceType::Single,
+		startVector2,
+		Datum.Start + (FVector(0, 0, -1) * 10000.f),
+		ECC_Visibility,
+		MakeSnapTraceParams(),
+		FCollisionResponseParams::DefaultResponseParam,
+		&TraceDelegate,
+		Datum.UserData);
+}
+
+void UBuildManagerComponent::OnSnapDownTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 Generation) {
+	if (Generation != snapGeneration || !managedBuildables.IsValidIndex(Datum.UserData)) {
+		return;
+	}
+
+	//If something is hit while going down, place the object there, else hide it so it is not placed
+	ABuildable* Preview = managedBuildables[Datum.UserData];
+	if (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit) {
+		FVector spawnVector = Datum.OutHits[0].ImpactPoint;
+		FRotator finRotation = FRotator(spawnVector.Rotation().Pitch, snapYaw, spawnVector.Rotation().Roll);
+		Preview->SetActorLocationAndRotation(spawnVector, finRotation);
+		Preview->SetActorHiddenInGame(false);
+	}
+	else {
+		Preview->SetActorHiddenInGame(true);
+	}
+
+	snappedSegments[Datum.UserData] = true;
+	if (releasePending && !snappedSegments.Contains(false)) {
+		ReleaseBuild();
+	}
+}
+
+ABuildable* UBuildManagerComponent::AcquirePreview(const FVector& Location, const FRotator& Rotation) {
+	ABuildable* Preview = nullptr;
+	while (Preview == nullptr && previewPool.Num() > 0) {
+		Preview = previewPool.Pop(false);
+		if (!IsValid(Preview)) {
+			Preview = nullptr;
 		}
 	}
-	else if(currentBuildable != nullptr) {
-		currentBuildable->Destroy();
+
+	if (Preview == nullptr) {
+		// Previews are local only, even on a listen server.
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.bDeferConstruction = true;
+		Preview = GetWorld()->SpawnActor<ABuildable>(BuildableFortification, Location, Rotation, SpawnParams);
+		Preview->SetReplicates(false);
+		Preview->FinishSpawning(FTransform(Rotation, Location));
+		return Preview;
+	}
+
+	Preview->SetActorLocationAndRotation(Location, Rotation);
+	Preview->PreviewMesh1->SetVisibility(true);
+	Preview->SetActorHiddenInGame(false);
+	return Preview;
+}
+
+void UBuildManagerComponent::ReleasePreview(ABuildable* Preview) {
+	if (IsValid(Preview)) {
+		Preview->SetActorHiddenInGame(true);
+		previewPool.Add(Preview);
+	}
+}
+
+void UBuildManagerComponent::ReleaseAllPreviews() {
+	for (int i = 0; i < managedBuildables.Num(); i++) {
+		ReleasePreview(managedBuildables[i]);
+	}
+	managedBuildables.Empty();
+
+	if (currentBuildable != nullptr) {
+		ReleasePreview(currentBuildable);
 		currentBuildable = nullptr;
 	}
 
+	snapGeneration++;
+	lastSnapSegments = 0;
+	snappedSegments.Reset();
+	releasePending = false;
 }
 
 void UBuildManagerComponent::ToggleBuildMode() {
 	isBuilding = !isBuilding;
 	GEngine->AddOnScreenDebugMessage(-1,15,FColor::Green,TEXT("ToogleBuildMode"));
-	if (!canBuild || !isBuilding) {
-		for (int i = 0; i < managedBuildables.Num(); i++) {
-			managedBuildables[i]->Destroy();
-		}
-	}
-	managedBuildables.Empty();
+	ReleaseAllPreviews();
+	previewMode = true;
+	SetComponentTickEnabled(isBuilding);
 }
 
 void UBuildManagerComponent::RequestBuild() {
@@ -212,39 +260,59 @@ void UBuildManagerComponent::RequestBuild() {
 }
 
 void UBuildManagerComponent::ReleaseBuild() {
-	currentBuildable->Destroy();
-	currentBuildable = nullptr;
-
-
 	if (canBuild && isBuilding) {
-		for (int i = 0; i < managedBuildables.Num(); i++) {
-			Server_PlaceBuildable(managedBuildables[i]->GetActorLocation(), managedBuildables[i]->GetActorRotation());
-			managedBuildables[i]->Destroy();
+		//Segments still waiting for their snap traces would be placed where they were first previewed, so wait for them
+		if (snappedSegments.Contains(false)) {
+			releasePending = true;
+			return;
 		}
-	}
 
-	if (!canBuild || !isBuilding) {
+		TArray<FBuildablePlacement> Placements;
+		Placements.Reserve(managedBuildables.Num());
 		for (int i = 0; i < managedBuildables.Num(); i++) {
-			managedBuildables[i]->Destroy();
+			// Segments that found no ground are hidden and not placed
+			if (!snappedSegments.IsValidIndex(i) || managedBuildables[i]->IsHidden()) {
+				continue;
+			}
+			FBuildablePlacement& Placement = Placements.AddDefaulted_GetRef();
+			Placement.Location = managedBuildables[i]->GetActorLocation();
+			Placement.Rotation = managedBuildables[i]->GetActorRotation();
+		}
+		if (Placements.Num() > 0) {
+			Server_PlaceBuildables(Placements);
 		}
 	}
-	managedBuildables.Empty();
+
+	ReleaseAllPreviews();
 		
 	previewMode = true;
 }
 
-bool UBuildManagerComponent::Server_PlaceBuildable_Validate(FVector const& Location, FRotator const& Rotation) {
+ABuildableManager* UBuildManagerComponent::GetBuildableManager() {
+	if (!CachedBuildableManager.IsValid()) {
+		TActorIterator<ABuildableManager> It(GetWorld());
+		CachedBuildableManager = It ? *It : nullptr;
+	}
+	return CachedBuildableManager.Get();
+}
+
+bool UBuildManagerComponent::Server_PlaceBuildables_Validate(const TArray<FBuildablePlacement>& Placements) {
 	return true;
 }
 
-void UBuildManagerComponent::Server_PlaceBuildable_Implementation(FVector const& Location, FRotator const& Rotation) {
-	
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ABuildableManager::StaticClass(), FoundActors);
-	ABuildableManager* foundManager = Cast<ABuildableManager>(FoundActors[0]);
-	
-	GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, TEXT("UBuildManagerComponent::Server_PlaceBuildable_Implementation"));
+void UBuildManagerComponent::Server_PlaceBuildables_Implementation(const TArray<FBuildablePlacement>& Placements) {
+	ABuildableManager* BuildableManager = GetBuildableManager();
+	if (BuildableManager == nullptr) {
+		return;
+	}
 
-	foundManager->SpawnRequest(BuildableFortification, Location, Rotation);
-}
+	FGenericTeamId Team = FGenericTeamId::NoTeam;
+	if (const UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(GetOwner())) {
+		Team = TeamComponent->GetTeam();
+	}
 
+	const int32 NumSegments = FMath::Min(Placements.Num(), MaxSegmentsPerPlacement);
+	for (int32 i = 0; i < NumSegments; i++) {
+		BuildableManager->AddBuildable(BuildableFortification, Placements[i].Location, Placements[i].Rotation, Team);
+	}
+}
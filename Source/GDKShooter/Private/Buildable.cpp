@@ -4,13 +4,18 @@
 #include "Buildable.h"
 #include "Components/BoxComponent.h"
 #include "Engine/CollisionProfile.h"
+#include "Systems/DamageSubsystem.h"
+#include "GDKStats.h"
 #include <Runtime\Engine\Public\Net\UnrealNetwork.h>
 
+DECLARE_CYCLE_STAT(TEXT("Buildable ApplyState"), STAT_BuildableApplyState, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildable State Changes"), STAT_BuildableStateChanges, STATGROUP_GDKShooter);
+
 // Sets default values
 ABuildable::ABuildable()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Placed buildables are instances owned by ABuildableManager, this actor is only a type description and placement preview.
+	PrimaryActorTick.bCanEverTick = false;
 	bReplicates = true;
 
 	TestTag1 = CreateDefaultSubobject<UTestTag>(TEXT("TestTag1"));
@@ -21,46 +26,58 @@ ABuildable::ABuildable()
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
 	RootComponent->SetIsReplicated(true);
 
+	// Mesh visibility and collision follow PackedState, so the meshes themselves are not replicated.
 	PreviewMesh1 = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("PreviewMesh"));
 	PreviewMesh1->SetupAttachment(RootComponent);
 	PreviewMesh1->SetVisibility(true);
 	PreviewMesh1->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
-	PreviewMesh1->SetIsReplicated(true);
-
 
+	// Build meshes keep the BlockAll profile and only have collision switched on and off, which needs no profile lookup.
 	BuildMesh1 = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BuildMesh1"));
 	BuildMesh1->SetupAttachment(RootComponent);
 	BuildMesh1->SetVisibility(false);
-	BuildMesh1->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
-	BuildMesh1->SetIsReplicated(true);
+	BuildMesh1->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	BuildMesh1->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
 	BuildMesh2 = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BuildMesh2"));
 	BuildMesh2->SetupAttachment(RootComponent);
 	BuildMesh2->SetVisibility(false);
-	BuildMesh2->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
-	BuildMesh2->SetIsReplicated(true);
+	BuildMesh2->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	BuildMesh2->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
 	BuildMesh3 = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BuildMesh3"));
 	BuildMesh3->SetupAttachment(RootComponent);
 	BuildMesh3->SetVisibility(false);
-	BuildMesh3->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
-	BuildMesh3->SetIsReplicated(true);
+	BuildMesh3->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	BuildMesh3->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	collision.Init(false, 3);
+	PackedState = PackState(0, false, FGenericTeamId::NoTeam);
+	activeBuildMesh = nullptr;
 }
 
 // Called when the game starts or when spawned
 void ABuildable::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (HasAuthority())
+	{
+		// Damage is resolved at the end of the frame, so react to the health component rather than right after TakeDamage.
+		HealthComponent->AuthoritativeDamage.AddDynamic(this, &ABuildable::OnAuthoritativeHealthChanged);
+		HealthComponent->AuthoritativeDeath.AddDynamic(this, &ABuildable::OnAuthoritativeHealthChanged);
+	}
+}
+
+void ABuildable::OnAuthoritativeHealthChanged(const AController* Instigator)
+{
+	HelathUpdate();
 }
 
 void ABuildable::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ABuildable,collision);
+	DOREPLIFETIME(ABuildable, PackedState);
 }
 
 // Called every frame
@@ -71,38 +88,71 @@ void ABuildable::Tick(float DeltaTime)
 }
 
 void ABuildable::Place() {
-	PreviewMesh1->SetVisibility(false);
-	BuildMesh1->SetVisibility(true);
-		
-	BuildMesh1->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
-	collision[0] = true;
+	SetPackedState(PackState(0, true, GetBuildTeam()));
 
 	
 	HealthComponent->GrantHealth((1 / 10) * HealthComponent->GetMaxHealth());
 	GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, TEXT("ABuildable::Place"));
 }
 
-void ABuildable::OnRep_Collision() {
-	if (collision[0]) {
-		BuildMesh1->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
-	}
-	else {
-		BuildMesh1->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+uint8 ABuildable::PackState(uint8 Stage, bool bPlaced, FGenericTeamId Team) {
+	const uint8 TeamBits = Team.GetId() < NoTeamBits ? Team.GetId() : NoTeamBits;
+	return (Stage & StageMask) | (bPlaced ? PlacedFlag : 0) | (TeamBits << TeamShift);
+}
+
+FGenericTeamId ABuildable::UnpackTeam(uint8 State) {
+	const uint8 TeamBits = State >> TeamShift;
+	return TeamBits == NoTeamBits ? FGenericTeamId::NoTeam : FGenericTeamId(TeamBits);
+}
+
+FGenericTeamId ABuildable::GetBuildTeam() const {
+	return UnpackTeam(PackedState);
+}
+
+void ABuildable::SetBuildTeam(FGenericTeamId Team) {
+	SetPackedState(PackState(GetStage(), IsPlaced(), Team));
+}
+
+void ABuildable::SetPackedState(uint8 NewState) {
+	if (NewState == PackedState) {
+		return;
 	}
+	PackedState = NewState;
+	ApplyPackedState();
+}
+
+void ABuildable::OnRep_PackedState() {
+	ApplyPackedState();
+}
 
-	if (collision[1]) {
-		BuildMesh2->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+UStaticMeshComponent* ABuildable::GetBuildMesh(uint8 Stage) const {
+	switch (Stage) {
+	case 0: return BuildMesh1;
+	case 1: return BuildMesh2;
+	case 2: return BuildMesh3;
+	default: return nullptr;
 	}
-	else {
-		BuildMesh2->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+}
+
+void ABuildable::ApplyPackedState() {
+	UStaticMeshComponent* newMesh = IsPlaced() ? GetBuildMesh(GetStage()) : nullptr;
+	if (newMesh == activeBuildMesh) {
+		return;
 	}
 
-	if (collision[2]) {
-		BuildMesh3->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	SCOPE_CYCLE_COUNTER(STAT_BuildableApplyState);
+	INC_DWORD_STAT(STAT_BuildableStateChanges);
+
+	if (activeBuildMesh != nullptr) {
+		activeBuildMesh->SetVisibility(false);
+		activeBuildMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	}
-	else {
-		BuildMesh3->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	if (newMesh != nullptr) {
+		PreviewMesh1->SetVisibility(false);
+		newMesh->SetVisibility(true);
+		newMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
 	}
+	activeBuildMesh = newMesh;
 }
 
 
@@ -113,46 +163,39 @@ void ABuildable::Build(float value) {
 }
 
 void ABuildable::HelathUpdate() {
+	uint8 stage = GetStage();
 	if (HealthComponent->GetCurrentHealth() >= 0.35 * HealthComponent->GetMaxHealth() && HealthComponent->GetCurrentHealth() <= 0.75 * HealthComponent->GetMaxHealth()) {
-		BuildMesh2->SetVisibility(true);
-		collision[1] = true;
-		BuildMesh2->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
-
-		BuildMesh1->SetVisibility(false);
-		collision[0] = false;
-		BuildMesh1->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
-
-		BuildMesh3->SetVisibility(false);
-		collision[2] = false;
-		BuildMesh3->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		stage = 1;
 	}
 	else if (HealthComponent->GetCurrentHealth() > 0.75 * HealthComponent->GetMaxHealth()) {
-		BuildMesh3->SetVisibility(true);
-		collision[2] = true;
-		BuildMesh3->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
-
-		BuildMesh1->SetVisibility(false);
-		collision[0] = false;
-		BuildMesh1->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
-
-		BuildMesh2->SetVisibility(false);
-		collision[1] = false;
-		BuildMesh2->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		stage = 2;
 	}
 	else if (HealthComponent->GetCurrentHealth() == 0) {
 		this->Destroy();
+		return;
 	}
+	SetPackedState(PackState(stage, true, GetBuildTeam()));
 }
 
 float ABuildable::TakeDamage(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	TakeDamageCrossServer(Damage, DamageEvent, EventInstigator, DamageCauser);
+	UDamageSubsystem::DealCrossServerDamage(this, Damage, DamageEvent, EventInstigator, DamageCauser);
 	return Damage;
 }
 
-void ABuildable::TakeDamageCrossServer_Implementation(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+void ABuildable::SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records)
 {
-	float ActualDamage = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
-	HealthComponent->TakeDamage(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
-	HelathUpdate();
+	TakeDamageCrossServer(Records);
+}
+
+void ABuildable::TakeDamageCrossServer_Implementation(const TArray<FCrossServerDamageRecord>& Records)
+{
+	for (const FCrossServerDamageRecord& Record : Records)
+	{
+		Record.Unpack([this](float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+		{
+			float ActualDamage = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
+			HealthComponent->TakeDamage(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
+		});
+	}
 }
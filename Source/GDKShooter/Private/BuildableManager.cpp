@@ -3,37 +3,1079 @@
 
 #include "BuildableManager.h"
 
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Deployments/DeploymentSnapshotTemplate.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineClasses/SpatialNetDriver.h"
+#include "GameFramework/PlayerController.h"
+#include "GDKLogging.h"
+#include "GDKStats.h"
+#include "Interop/Connection/SpatialWorkerConnection.h"
+#include "Interop/SpatialReceiver.h"
+#include "Net/UnrealNetwork.h"
+#include "Systems/DamageSubsystem.h"
+#include "Systems/RadialDamageSubsystem.h"
+#include "TimerManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Buildable Instances"), STAT_BuildableInstances, STATGROUP_GDKShooter);
+DECLARE_CYCLE_STAT(TEXT("BuildableManager Damage"), STAT_BuildableManagerDamage, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildable Placements Rejected"), STAT_BuildablePlacementsRejected, STATGROUP_GDKShooter);
+DECLARE_CYCLE_STAT(TEXT("BuildableManager Import"), STAT_BuildableManagerImport, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildables Imported"), STAT_BuildablesImported, STATGROUP_GDKShooter);
+DECLARE_CYCLE_STAT(TEXT("BuildableManager Support"), STAT_BuildableManagerSupport, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildables Collapsed"), STAT_BuildablesCollapsed, STATGROUP_GDKShooter);
+DECLARE_CYCLE_STAT(TEXT("BuildableManager Far Field"), STAT_BuildableManagerFarField, STATGROUP_GDKShooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Buildable Proxy Cells"), STAT_BuildableProxyCells, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildable Far Field Swaps"), STAT_BuildableFarFieldSwaps, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildable Stage Swaps"), STAT_BuildableStageSwaps, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildable Hits Rerouted"), STAT_BuildableHitsRerouted, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buildable Explosion Occlusion Traces"), STAT_BuildableOcclusionTraces, STATGROUP_GDKShooter);
+
+namespace
+{
+	float GetRadiusAroundOrigin(const FBox& LocalBounds)
+	{
+		return FVector(
+			FMath::Max(FMath::Abs(LocalBounds.Min.X), FMath::Abs(LocalBounds.Max.X)),
+			FMath::Max(FMath::Abs(LocalBounds.Min.Y), FMath::Abs(LocalBounds.Max.Y)),
+			FMath::Max(FMath::Abs(LocalBounds.Min.Z), FMath::Abs(LocalBounds.Max.Z))).Size();
+	}
+
+	// Separating axis test on the face axes of both boxes, so exact for pieces that only differ in yaw, and conservative otherwise.
+	bool LocalBoundsOverlap(const FBox& LocalA, const FTransform& TransformA, const FBox& LocalB, const FTransform& TransformB)
+	{
+		return LocalA.Intersect(LocalB.TransformBy(TransformB.GetRelativeTransform(TransformA)))
+			&& LocalB.Intersect(LocalA.TransformBy(TransformA.GetRelativeTransform(TransformB)));
+	}
+}
+
+void FBuildableInstance::PreReplicatedRemove(const FBuildableInstanceArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HideInstance(Id);
+	}
+}
+
+void FBuildableInstance::PostReplicatedAdd(const FBuildableInstanceArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->ShowInstance(*this);
+	}
+}
+
+void FBuildableInstance::PostReplicatedChange(const FBuildableInstanceArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->UpdateInstanceStage(*this);
+	}
+}
+
 // Sets default values
 ABuildableManager::ABuildableManager()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Only ticks while importing saved buildables or settling collapses.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bReplicates = true;
+	bAlwaysRelevant = true;
 
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
+}
+
+void ABuildableManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	Instances.Owner = this;
+	Grid.SetCellSize(PlacementCellSize);
 }
 
-// Called when the game starts or when spawned
 void ABuildableManager::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (HasAuthority())
+	{
+		LoadSavedBuildables();
+	}
+
+	// Explosions on any server are forwarded to the authoritative worker as cross-server damage.
+	if (GetNetMode() != NM_Client)
+	{
+		if (URadialDamageSubsystem* RadialDamage = GetWorld()->GetSubsystem<URadialDamageSubsystem>())
+		{
+			RadialDamage->RegisterInstancedDamageable(this);
+		}
+	}
+
+	if (UsesFarFieldProxies())
+	{
+		GetWorldTimerManager().SetTimer(FarFieldTimer, this, &ABuildableManager::UpdateFarField, FarFieldUpdateInterval, true);
+	}
+}
+
+void ABuildableManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Buildables still waiting to be imported would be lost, so only save once the import has finished.
+	if (HasAuthority() && bSaveOnEndPlay && NextPendingImport >= PendingImport.Records.Num())
+	{
+		SaveBuildables();
+	}
+
+	GetWorldTimerManager().ClearTimer(FarFieldTimer);
+
+	if (URadialDamageSubsystem* RadialDamage = GetWorld()->GetSubsystem<URadialDamageSubsystem>())
+	{
+		RadialDamage->UnregisterInstancedDamageable(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABuildableManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ABuildableManager, Instances);
+	DOREPLIFETIME(ABuildableManager, BuildableTypes);
+}
+
+void ABuildableManager::SpawnRequest(TSubclassOf<class ABuildable> BuildableFortification, FVector const& Location, FRotator const& Rotation) {
+	AddBuildable(BuildableFortification, Location, Rotation, FGenericTeamId::NoTeam);
+}
+
+int32 ABuildableManager::GetOrAddTypeIndex(TSubclassOf<ABuildable> BuildableType)
+{
+	int32 TypeIndex = BuildableTypes.Find(BuildableType);
+	if (TypeIndex == INDEX_NONE)
+	{
+		if (BuildableTypes.Num() > MAX_uint8)
+		{
+			return INDEX_NONE;
+		}
+		TypeIndex = BuildableTypes.Add(BuildableType);
+	}
+	return TypeIndex;
+}
+
+float ABuildableManager::GetMaxHealth(uint8 TypeIndex) const
+{
+	const ABuildable* Defaults = BuildableTypes.IsValidIndex(TypeIndex) ? GetDefault<ABuildable>(BuildableTypes[TypeIndex]) : nullptr;
+	return Defaults && Defaults->HealthComponent ? Defaults->HealthComponent->GetMaxHealth() : 100.0f;
+}
+
+int32 ABuildableManager::AddBuildable(TSubclassOf<ABuildable> BuildableType, const FVector& Location, const FRotator& Rotation, FGenericTeamId Team)
+{
+	if (!HasAuthority() || BuildableType == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	if (!CanPlaceBuildable(BuildableType, Location, Rotation))
+	{
+		INC_DWORD_STAT(STAT_BuildablePlacementsRejected);
+		return INDEX_NONE;
+	}
+
+	const int32 TypeIndex = GetOrAddTypeIndex(BuildableType);
+	if (TypeIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	const ABuildable* Defaults = GetDefault<ABuildable>(BuildableType);
+	const float Health = Defaults->HealthComponent ? Defaults->HealthComponent->GetCurrentHealth() : GetMaxHealth(TypeIndex);
+
+	return AddInstance(TypeIndex, Location, Rotation, Team, 0, Health);
+}
+
+int32 ABuildableManager::AddInstance(int32 TypeIndex, const FVector& Location, const FRotator& Rotation, FGenericTeamId Team, uint8 Stage, float Health)
+{
+	FBuildableInstance& Instance = Instances.Items.AddDefaulted_GetRef();
+	Instance.Id = NextInstanceId++;
+	Instance.TypeIndex = TypeIndex;
+	Instance.PackedState = ABuildable::PackState(Stage, true, Team);
+	Instance.Location = Location;
+	Instance.Rotation = Rotation;
+	Instance.Health = Health;
+	Instance.QuantizedHealth = (uint8)FMath::Clamp(FMath::CeilToInt(Instance.Health / GetMaxHealth(TypeIndex) * 127.0f), 0, 127);
+
+	// Neighbours are gathered before the new piece is in the grid, so it is not its own neighbour.
+	SupportIds.Reset();
+	GetBuildablesNear(Location, SupportRadius, SupportIds);
+	SupportGraph.Add(Instance.Id, IsGrounded(Location), SupportIds);
+
+	InstanceIndices.Add(Instance.Id, Instances.Items.Num() - 1);
+	Grid.Add(Instance.Id, Location);
+	Instances.MarkItemDirty(Instance);
+	ShowInstance(Instance);
+
+	INC_DWORD_STAT(STAT_BuildableInstances);
+	return Instance.Id;
+}
+
+bool ABuildableManager::RemoveBuildable(int32 Id)
+{
+	int32 ItemIndex;
+	if (!InstanceIndices.RemoveAndCopyValue(Id, ItemIndex))
+	{
+		return false;
+	}
+
+	HideInstance(Id);
+	Grid.Remove(Id, Instances.Items[ItemIndex].Location);
+
+	SupportGraph.Remove(Id);
+	if (SupportGraph.HasWork())
+	{
+		SetActorTickEnabled(true);
+	}
+
+	Instances.Items.RemoveAtSwap(ItemIndex, 1, false);
+	if (Instances.Items.IsValidIndex(ItemIndex))
+	{
+		InstanceIndices.Add(Instances.Items[ItemIndex].Id, ItemIndex);
+	}
+	Instances.MarkArrayDirty();
+
+	DEC_DWORD_STAT(STAT_BuildableInstances);
+	return true;
+}
+
+uint8 ABuildableManager::GetStageForHealth(float Health, float MaxHealth, uint8 CurrentStage)
+{
+	if (Health > 0.75f * MaxHealth)
+	{
+		return 2;
+	}
+	if (Health >= 0.35f * MaxHealth)
+	{
+		return 1;
+	}
+	return CurrentStage;
+}
+
+void ABuildableManager::ModifyHealth(int32 ItemIndex, float Delta)
+{
+	FBuildableInstance& Instance = Instances.Items[ItemIndex];
+	const float MaxHealth = GetMaxHealth(Instance.TypeIndex);
+
+	Instance.Health = FMath::Clamp(Instance.Health + Delta, 0.0f, MaxHealth);
+	if (Instance.Health <= 0.0f)
+	{
+		RemoveBuildable(Instance.Id);
+		return;
+	}
+
+	const uint8 Stage = GetStageForHealth(Instance.Health, MaxHealth, Instance.GetStage());
+	const uint8 QuantizedHealth = (uint8)FMath::Clamp(FMath::CeilToInt(Instance.Health / MaxHealth * 127.0f), 0, 127);
+	if (Stage == Instance.GetStage() && QuantizedHealth == Instance.QuantizedHealth)
+	{
+		return;
+	}
+
+	const bool bStageChanged = Stage != Instance.GetStage();
+	Instance.PackedState = ABuildable::PackState(Stage, true, Instance.GetTeam());
+	Instance.QuantizedHealth = QuantizedHealth;
+	Instances.MarkItemDirty(Instance);
+
+	if (bStageChanged)
+	{
+		UpdateInstanceStage(Instance);
+	}
+}
+
+bool ABuildableManager::CanPlaceBuildable(TSubclassOf<ABuildable> BuildableType, const FVector& Location, const FRotator& Rotation) const
+{
+	if (Grid.CountInCell(Location) >= MaxBuildablesPerCell || Grid.AnyWithin(Location, MinPlacementSpacing))
+	{
+		return false;
+	}
+
+	const FBox LocalBounds = GetPlacementBounds(BuildableType);
+	if (!LocalBounds.IsValid)
+	{
+		return true;
+	}
+
+	// Origins alone let long pieces placed side by side interpenetrate, so neighbours that could reach the new piece are tested by mesh bounds.
+	TArray<FBox, TInlineAllocator<8>> TypeBounds;
+	float MaxTypeRadius = 0.0f;
+	for (const TSubclassOf<ABuildable>& Type : BuildableTypes)
+	{
+		const FBox& Bounds = TypeBounds.Add_GetRef(GetPlacementBounds(Type));
+		MaxTypeRadius = Bounds.IsValid ? FMath::Max(MaxTypeRadius, GetRadiusAroundOrigin(Bounds)) : MaxTypeRadius;
+	}
+
+	const FTransform Transform(Rotation, Location);
+	bool bOverlaps = false;
+	Grid.ForEachWithin(Location, GetRadiusAroundOrigin(LocalBounds) + MaxTypeRadius, [&](const FBuildableGrid::FEntry& Entry, float DistSq)
+	{
+		const FBuildableInstance& Other = Instances.Items[InstanceIndices.FindChecked(Entry.Id)];
+		const FBox& OtherBounds = TypeBounds[Other.TypeIndex];
+		bOverlaps = OtherBounds.IsValid && LocalBoundsOverlap(LocalBounds, Transform, OtherBounds, FTransform(Other.Rotation, Other.Location));
+		return !bOverlaps;
+	});
+	return !bOverlaps;
+}
+
+int32 ABuildableManager::FindInstanceNear(const FVector& Location) const
+{
+	const int32* ItemIndex = InstanceIndices.Find(Grid.FindClosest(Location, DamageRouteRadius));
+	return ItemIndex ? *ItemIndex : INDEX_NONE;
+}
+
+int32 ABuildableManager::FindHitInstance(const FVector& Location, int32 Id) const
+{
+	if (Id == INDEX_NONE)
+	{
+		return FindInstanceNear(Location);
+	}
+
+	// The piece may already have been destroyed, its neighbours are not hit in its place.
+	const int32* ItemIndex = InstanceIndices.Find(Id);
+	if (ItemIndex == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	// Impact points lie on the mesh's surface, so on the bounds' faces at most.
+	const FBuildableInstance& Instance = Instances.Items[*ItemIndex];
+	if (FVector::DistSquared(Location, Instance.Location) <= FMath::Square(DamageRouteRadius) || GetInstanceBounds(Instance).ExpandBy(1.0f).IsInsideOrOn(Location))
+	{
+		return *ItemIndex;
+	}
+
+	INC_DWORD_STAT(STAT_BuildableHitsRerouted);
+	return FindInstanceNear(Location);
+}
+
+const UStaticMeshComponent* ABuildableManager::GetStageMesh(uint8 TypeIndex, uint8 Stage) const
+{
+	if (!BuildableTypes.IsValidIndex(TypeIndex) || BuildableTypes[TypeIndex] == nullptr)
+	{
+		return nullptr;
+	}
+
+	const ABuildable* Defaults = GetDefault<ABuildable>(BuildableTypes[TypeIndex]);
+	return Stage == 0 ? Defaults->BuildMesh1 : Stage == 1 ? Defaults->BuildMesh2 : Defaults->BuildMesh3;
+}
+
+FBox ABuildableManager::GetInstanceBounds(const FBuildableInstance& Instance) const
+{
+	const FTransform ActorTransform(Instance.Rotation, Instance.Location);
+	const UStaticMeshComponent* StageMesh = GetStageMesh(Instance.TypeIndex, Instance.GetStage());
+	if (StageMesh == nullptr || StageMesh->GetStaticMesh() == nullptr)
+	{
+		return FBox(Instance.Location, Instance.Location);
+	}
+
+	return StageMesh->GetStaticMesh()->GetBoundingBox().TransformBy(StageMesh->GetRelativeTransform() * ActorTransform);
+}
+
+FBox ABuildableManager::GetPlacementBounds(TSubclassOf<ABuildable> BuildableType) const
+{
+	FBox LocalBounds(ForceInit);
+	const ABuildable* Defaults = BuildableType != nullptr ? GetDefault<ABuildable>(BuildableType) : nullptr;
+	if (Defaults != nullptr)
+	{
+		for (const UStaticMeshComponent* StageMesh : { Defaults->BuildMesh1, Defaults->BuildMesh2, Defaults->BuildMesh3 })
+		{
+			if (StageMesh && StageMesh->GetStaticMesh())
+			{
+				LocalBounds += StageMesh->GetStaticMesh()->GetBoundingBox().TransformBy(StageMesh->GetRelativeTransform());
+			}
+		}
+	}
+	if (!LocalBounds.IsValid)
+	{
+		return LocalBounds;
+	}
+
+	// Thin pieces shrink to a plane at most, never inside out.
+	return LocalBounds.ExpandBy(-FMath::Min(PlacementOverlapTolerance, LocalBounds.GetExtent().GetMin()));
+}
+
+bool ABuildableManager::IsExplosionOccluded(const FVector& Origin, int32 Id, const AActor* DamageCauser) const
+{
+	const int32* ItemIndex = InstanceIndices.Find(Id);
+	if (ItemIndex == nullptr || ExplosionOcclusionChannel == ECC_MAX)
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_BuildableOcclusionTraces);
+
+	// Traced to the piece's bounds centre, so the first blocker is the piece itself unless something stands in between.
+	FCollisionQueryParams LineParams(SCENE_QUERY_STAT(BuildableExplosionOcclusion), false, DamageCauser);
+	FHitResult Blocker;
+	const FVector Target = GetInstanceBounds(Instances.Items[*ItemIndex]).GetCenter();
+	if (!GetWorld()->LineTraceSingleByChannel(Blocker, Origin, Target, ExplosionOcclusionChannel, LineParams))
+	{
+		return false;
+	}
+	return Blocker.GetActor() != this || GetHitBuildableId(Blocker) != Id;
+}
+
+void ABuildableManager::GetBuildablesNear(const FVector& Location, float Radius, TArray<int32>& OutIds) const
+{
+	Grid.ForEachWithin(Location, Radius, [&OutIds](const FBuildableGrid::FEntry& Entry, float DistSq)
+	{
+		OutIds.Add(Entry.Id);
+		return true;
+	});
+}
+
+TArray<FVector> ABuildableManager::GetBuildableLocationsNear(FVector Location, float Radius) const
+{
+	TArray<FVector> Locations;
+	Grid.ForEachWithin(Location, Radius, [&Locations](const FBuildableGrid::FEntry& Entry, float DistSq)
+	{
+		Locations.Add(Entry.Location);
+		return true;
+	});
+	return Locations;
+}
+
+void ABuildableManager::RepairAt(const FVector& Location, float Value, int32 Id)
+{
+	const int32 ItemIndex = FindHitInstance(Location, Id);
+	if (ItemIndex != INDEX_NONE)
+	{
+		ModifyHealth(ItemIndex, Value);
+	}
+}
+
+int32 ABuildableManager::GetHitBuildableId(const FHitResult& Hit) const
+{
+	const UPrimitiveComponent* HitComponent = Hit.GetComponent();
+	if (HitComponent == nullptr || HitComponent->GetOwner() != this)
+	{
+		return Hit.Item;
+	}
+
+	const int32 Id = RenderLayer.FindId(HitComponent, Hit.Item);
+	return Id != INDEX_NONE ? Id : CollisionLayer.FindId(HitComponent, Hit.Item);
+}
+
+float ABuildableManager::TakeDamage(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	{
+		// Instance indices differ between machines, so the hit piece travels as its id.
+		FPointDamageEvent PointDamageEvent = static_cast<const FPointDamageEvent&>(DamageEvent);
+		PointDamageEvent.HitInfo.Item = GetHitBuildableId(PointDamageEvent.HitInfo);
+		PointDamageEvent.HitInfo.Component = nullptr;
+		UDamageSubsystem::DealCrossServerDamage(this, Damage, PointDamageEvent, EventInstigator, DamageCauser);
+		return Damage;
+	}
+
+	UDamageSubsystem::DealCrossServerDamage(this, Damage, DamageEvent, EventInstigator, DamageCauser);
+	return Damage;
+}
+
+void ABuildableManager::SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records)
+{
+	TakeDamageCrossServer(Records);
+}
+
+void ABuildableManager::TakeDamageCrossServer_Implementation(const TArray<FCrossServerDamageRecord>& Records)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildableManagerDamage);
+
+	for (const FCrossServerDamageRecord& Record : Records)
+	{
+		// Point damage is routed by the hit piece's id and radial damage by origin, there is nothing to route generic damage by.
+		if (Record.Kind == ECrossServerDamageKind::Point)
+		{
+			const int32 ItemIndex = FindHitInstance(Record.Location, Record.Item);
+			if (ItemIndex != INDEX_NONE)
+			{
+				ModifyHealth(ItemIndex, -Record.Damage);
+			}
+		}
+		else if (Record.Kind == ECrossServerDamageKind::Radial)
+		{
+			// Collected first, as damage may remove buildables from the grid.
+			SplashIds.Reset();
+			SplashDamage.Reset();
+			if (Record.RadialParams.OuterRadius > 0.0f)
+			{
+				// Explosions from URadialDamageSubsystem: falloff as in AActor::InternalTakeRadialDamage, by each piece's distance to the origin.
+				const FRadialDamageParams& Params = Record.RadialParams;
+				Grid.ForEachWithin(Record.Location, Params.OuterRadius, [this, &Record, &Params](const FBuildableGrid::FEntry& Entry, float DistSq)
+				{
+					SplashIds.Add(Entry.Id);
+					SplashDamage.Add(FMath::Lerp(Params.MinimumDamage, Record.Damage, FMath::Max(0.0f, Params.GetDamageScale(FMath::Sqrt(DistSq)))));
+					return true;
+				});
+
+				// Pieces behind walls are spared, as actors are.
+				for (int32 i = SplashIds.Num() - 1; i >= 0; i--)
+				{
+					if (IsExplosionOccluded(Record.Location, SplashIds[i], Record.DamageCauser))
+					{
+						SplashIds.RemoveAtSwap(i, 1, false);
+						SplashDamage.RemoveAtSwap(i, 1, false);
+					}
+				}
+			}
+			else
+			{
+				// Falloff was already applied by the sender against one of the render components.
+				GetBuildablesNear(Record.Location, DamageRouteRadius, SplashIds);
+				SplashDamage.Init(Record.Damage, SplashIds.Num());
+			}
+
+			for (int32 i = 0; i < SplashIds.Num(); i++)
+			{
+				if (const int32* ItemIndex = InstanceIndices.Find(SplashIds[i]))
+				{
+					ModifyHealth(*ItemIndex, -SplashDamage[i]);
+				}
+			}
+		}
+	}
+}
+
+int32 FBuildableInstanceLayer::FindId(const UPrimitiveComponent* Component, int32 Item) const
+{
+	// Components has empty slots for types and stages that were never shown.
+	const int32 ComponentIndex = Component != nullptr ? Components.IndexOfByKey(Component) : INDEX_NONE;
+	if (ComponentIndex == INDEX_NONE || !InstanceIds[ComponentIndex].IsValidIndex(Item))
+	{
+		return INDEX_NONE;
+	}
+	return InstanceIds[ComponentIndex][Item];
+}
+
+UHierarchicalInstancedStaticMeshComponent* ABuildableManager::GetLayerComponent(FBuildableInstanceLayer& Layer, uint8 TypeIndex, uint8 Stage, int32& OutComponentIndex)
+{
+	OutComponentIndex = TypeIndex * NumStages + Stage;
+	if (Layer.Components.IsValidIndex(OutComponentIndex) && Layer.Components[OutComponentIndex] != nullptr)
+	{
+		return Layer.Components[OutComponentIndex];
+	}
+
+	if (!BuildableTypes.IsValidIndex(TypeIndex) || BuildableTypes[TypeIndex] == nullptr)
+	{
+		return nullptr;
+	}
+
+	const UStaticMeshComponent* StageMesh = GetStageMesh(TypeIndex, Stage);
+
+	UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	Component->SetupAttachment(RootComponent);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetStaticMesh(StageMesh ? StageMesh->GetStaticMesh() : nullptr);
+	if (&Layer == &CollisionLayer)
+	{
+		Component->SetVisibility(false);
+		Component->SetCastShadow(false);
+		Component->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	}
+	else if (UsesFarFieldProxies())
+	{
+		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+	else
+	{
+		Component->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	}
+	Component->RegisterComponent();
+
+	if (Layer.Components.Num() <= OutComponentIndex)
+	{
+		Layer.Components.SetNumZeroed(OutComponentIndex + 1);
+		Layer.InstanceIds.SetNum(OutComponentIndex + 1);
+	}
+	Layer.Components[OutComponentIndex] = Component;
+	return Component;
+}
+
+void ABuildableManager::AddLayerInstance(FBuildableInstanceLayer& Layer, const FBuildableInstance& Instance)
+{
+	int32 ComponentIndex;
+	UHierarchicalInstancedStaticMeshComponent* Component = GetLayerComponent(Layer, Instance.TypeIndex, Instance.GetStage(), ComponentIndex);
+	if (Component == nullptr)
+	{
+		// The type has not replicated yet, OnRep_BuildableTypes shows it later.
+		return;
+	}
+
+	if (const FBuildableInstanceHandle* Existing = Layer.Handles.Find(Instance.Id))
+	{
+		if (Existing->ComponentIndex == ComponentIndex)
+		{
+			return;
+		}
+
+		// A new stage is a different mesh, so the instance moves to that stage's component.
+		INC_DWORD_STAT(STAT_BuildableStageSwaps);
+		RemoveLayerInstance(Layer, Instance.Id);
+	}
+
+	// Build meshes keep their offset within the buildable.
+	const UStaticMeshComponent* StageMesh = GetStageMesh(Instance.TypeIndex, Instance.GetStage());
+	const FTransform ActorTransform(Instance.Rotation, Instance.Location);
+	const FTransform InstanceTransform = StageMesh ? StageMesh->GetRelativeTransform() * ActorTransform : ActorTransform;
+
+	FBuildableInstanceHandle Handle;
+	Handle.ComponentIndex = ComponentIndex;
+	Handle.InstanceIndex = Component->AddInstanceWorldSpace(InstanceTransform);
+	Layer.Handles.Add(Instance.Id, Handle);
+
+	TArray<int32>& Ids = Layer.InstanceIds[ComponentIndex];
+	Ids.SetNum(FMath::Max(Ids.Num(), Handle.InstanceIndex + 1));
+	Ids[Handle.InstanceIndex] = Instance.Id;
+}
+
+void ABuildableManager::RemoveLayerInstance(FBuildableInstanceLayer& Layer, int32 Id)
+{
+	FBuildableInstanceHandle Handle;
+	if (!Layer.Handles.RemoveAndCopyValue(Id, Handle))
+	{
+		return;
+	}
+
+	Layer.Components[Handle.ComponentIndex]->RemoveInstance(Handle.InstanceIndex);
+
+	// Hierarchical instanced meshes remove by swapping the last instance into the freed slot.
+	TArray<int32>& Ids = Layer.InstanceIds[Handle.ComponentIndex];
+	Ids.RemoveAtSwap(Handle.InstanceIndex, 1, false);
+	if (Ids.IsValidIndex(Handle.InstanceIndex))
+	{
+		Layer.Handles[Ids[Handle.InstanceIndex]].InstanceIndex = Handle.InstanceIndex;
+	}
+}
+
+void ABuildableManager::OnRep_BuildableTypes()
+{
+	// With far-field proxies, pieces in far cells are only in the collision layer.
+	const FBuildableInstanceLayer& ShownLayer = UsesFarFieldProxies() ? CollisionLayer : RenderLayer;
+	for (const FBuildableInstance& Instance : Instances.Items)
+	{
+		if (!ShownLayer.Handles.Contains(Instance.Id))
+		{
+			ShowInstance(Instance);
+		}
+	}
+}
+
+void ABuildableManager::ExportSnapshot(FBuildableSnapshot& OutSnapshot) const
+{
+	for (const TSubclassOf<ABuildable>& BuildableType : BuildableTypes)
+	{
+		OutSnapshot.Types.Add(FSoftClassPath(BuildableType.Get()).ToString());
+	}
+
+	OutSnapshot.Records.Reserve(OutSnapshot.Records.Num() + Instances.Items.Num());
+	for (const FBuildableInstance& Instance : Instances.Items)
+	{
+		FBuildableSnapshotRecord& Record = OutSnapshot.Records.AddDefaulted_GetRef();
+		Record.Location = Instance.Location;
+		Record.Rotation = Instance.Rotation;
+		Record.TypeIndex = Instance.TypeIndex;
+		Record.Stage = Instance.GetStage();
+		Record.TeamId = Instance.GetTeam().GetId();
+		Record.QuantizedHealth = Instance.QuantizedHealth;
+	}
+}
+
+bool ABuildableManager::SaveBuildables() const
+{
+	if (!HasAuthority())
+	{
+		return false;
+	}
+
+	FBuildableSnapshot Snapshot;
+	ExportSnapshot(Snapshot);
+	if (!Snapshot.SaveToFile())
+	{
+		UE_LOG(LogGDK, Warning, TEXT("Failed to save %d buildables to %s"), Snapshot.Records.Num(), *FBuildableSnapshot::GetSaveFilePath());
+		return false;
+	}
+	return true;
+}
+
+void ABuildableManager::LoadSavedBuildables()
+{
+	USpatialNetDriver* SpatialNetDriver = Cast<USpatialNetDriver>(GetWorld()->GetNetDriver());
+	if (!GetDefault<UDeploymentSnapshotTemplate>()->bWriteSavedBuildables)
+	{
+		// No chunk entities were written, and their component may not be in the schema.
+		SpatialNetDriver = nullptr;
+	}
+
+	if (SpatialNetDriver == nullptr || SpatialNetDriver->Connection == nullptr || SpatialNetDriver->Receiver == nullptr)
+	{
+		// A file left by an earlier session that opted in is ignored by sessions that did not.
+		FBuildableSnapshot Snapshot;
+		if (bSaveOnEndPlay && Snapshot.LoadFromFile())
+		{
+			ImportSnapshot(Snapshot);
+		}
+		return;
+	}
+
+	// The chunk entities may already be checked out, so they are queried rather than waited for.
+	Worker_Constraint Constraint{};
+	Constraint.constraint_type = WORKER_CONSTRAINT_TYPE_COMPONENT;
+	Constraint.constraint.component_constraint.component_id = FBuildableSnapshot::ChunkComponentId;
+
+	Worker_EntityQuery Query{};
+	Query.constraint = Constraint;
+	Query.result_type = WORKER_RESULT_TYPE_SNAPSHOT;
+
+	const Worker_RequestId RequestId = SpatialNetDriver->Connection->SendEntityQueryRequest(&Query);
+
+	EntityQueryDelegate QueryDelegate;
+	QueryDelegate.BindUObject(this, &ABuildableManager::OnSnapshotQueryResponse);
+	SpatialNetDriver->Receiver->AddEntityQueryDelegate(RequestId, QueryDelegate);
+}
+
+void ABuildableManager::OnSnapshotQueryResponse(const Worker_EntityQueryResponseOp& Op)
+{
+	if (Op.status_code != WORKER_STATUS_CODE_SUCCESS)
+	{
+		UE_LOG(LogGDK, Warning, TEXT("Querying saved buildables failed: %s"), UTF8_TO_TCHAR(Op.message));
+		return;
+	}
+
+	FBuildableSnapshot Snapshot;
+	for (uint32 EntityIndex = 0; EntityIndex < Op.result_count; EntityIndex++)
+	{
+		const Worker_Entity& Entity = Op.results[EntityIndex];
+		for (uint32 ComponentIndex = 0; ComponentIndex < Entity.component_count; ComponentIndex++)
+		{
+			const Worker_ComponentData& Component = Entity.components[ComponentIndex];
+			if (Component.component_id != FBuildableSnapshot::ChunkComponentId)
+			{
+				continue;
+			}
+
+			FBuildableSnapshot Chunk;
+			if (Chunk.ReadChunkComponent(Schema_GetComponentDataFields(Component.schema_type)))
+			{
+				Snapshot.Append(Chunk);
+			}
+			else
+			{
+				UE_LOG(LogGDK, Warning, TEXT("Ignoring unreadable buildable chunk on entity %lld"), Entity.entity_id);
+			}
+		}
+	}
+
+	ImportSnapshot(Snapshot);
+}
+
+void ABuildableManager::ImportSnapshot(const FBuildableSnapshot& Snapshot)
+{
+	// Buildables already placed would be duplicated, e.g. if the manager is restored from a running deployment's snapshot.
+	if (Snapshot.Records.Num() == 0 || Instances.Items.Num() > 0 || NextPendingImport < PendingImport.Records.Num())
+	{
+		return;
+	}
+
+	PendingImport = Snapshot;
+	NextPendingImport = 0;
+
+	PendingImportTypes.Reset();
+	for (const FString& Type : PendingImport.Types)
+	{
+		UClass* BuildableType = FSoftClassPath(Type).TryLoadClass<ABuildable>();
+		if (BuildableType == nullptr)
+		{
+			UE_LOG(LogGDK, Warning, TEXT("Saved buildables of unknown type %s are skipped"), *Type);
+		}
+		PendingImportTypes.Add(BuildableType);
+	}
+
+	SetActorTickEnabled(true);
 }
 
-// Called every frame
 void ABuildableManager::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (NextPendingImport < PendingImport.Records.Num())
+	{
+		ImportPending();
+	}
+
+	UpdateSupport();
+
+	if (!HasPendingWork())
+	{
+		SetActorTickEnabled(false);
+	}
 }
 
-void ABuildableManager::SpawnRequest(TSubclassOf<class ABuildable> BuildableFortification, FVector const& Location, FRotator const& Rotation) {
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+bool ABuildableManager::HasPendingWork() const
+{
+	return NextPendingImport < PendingImport.Records.Num() || SupportGraph.HasWork() || PendingCollapses.Num() > 0;
+}
+
+void ABuildableManager::ImportPending()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildableManagerImport);
+
+	const double EndTime = FPlatformTime::Seconds() + ImportBudgetMs / 1000.0;
+	int32 Imported = 0;
+
+	while (NextPendingImport < PendingImport.Records.Num())
+	{
+		const FBuildableSnapshotRecord& Record = PendingImport.Records[NextPendingImport++];
+
+		const TSubclassOf<ABuildable> BuildableType = PendingImportTypes.IsValidIndex(Record.TypeIndex) ? PendingImportTypes[Record.TypeIndex] : nullptr;
+		const int32 TypeIndex = BuildableType != nullptr && CanPlaceBuildable(BuildableType, Record.Location, Record.Rotation) ? GetOrAddTypeIndex(BuildableType) : INDEX_NONE;
+		if (TypeIndex != INDEX_NONE)
+		{
+			const float Health = FMath::Max(Record.QuantizedHealth / 127.0f * GetMaxHealth(TypeIndex), 1.0f);
+			AddInstance(TypeIndex, Record.Location, Record.Rotation, FGenericTeamId(Record.TeamId), FMath::Min<uint8>(Record.Stage, NumStages - 1), Health);
+			INC_DWORD_STAT(STAT_BuildablesImported);
+		}
+
+		// Placing a piece costs about as much as reading the clock, so it is only checked every few pieces.
+		if ((++Imported % 32) == 0 && FPlatformTime::Seconds() >= EndTime)
+		{
+			return;
+		}
+	}
+
+	PendingImport = FBuildableSnapshot();
+	NextPendingImport = 0;
+	PendingImportTypes.Reset();
+}
+
+bool ABuildableManager::IsGrounded(const FVector& Location) const
+{
+	// Buildables are all instances on this actor, ignoring it leaves only the level.
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(BuildableGroundTrace), false, this);
+	const FVector Start = Location + FVector(0.0f, 0.0f, GroundTraceDistance);
+	const FVector End = Location - FVector(0.0f, 0.0f, GroundTraceDistance);
+	return GetWorld()->LineTraceTestByChannel(Start, End, ECC_Visibility, TraceParams);
+}
+
+void ABuildableManager::UpdateSupport()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildableManagerSupport);
+
+	// Unsupported pieces are already out of the support graph, removing them queues no further searches.
+	const int32 NumCollapses = FMath::Min(PendingCollapses.Num(), CollapsesPerFrame);
+	for (int32 i = 0; i < NumCollapses; i++)
+	{
+		if (RemoveBuildable(PendingCollapses.Pop(false)))
+		{
+			INC_DWORD_STAT(STAT_BuildablesCollapsed);
+		}
+	}
+
+	SupportGraph.Update(SupportVisitsPerFrame, PendingCollapses);
+}
+
+void ABuildableManager::ShowInstance(const FBuildableInstance& Instance)
+{
+	if (!UsesFarFieldProxies())
+	{
+		AddLayerInstance(RenderLayer, Instance);
+		return;
+	}
+
+	// Only the drawing of far pieces is swapped for their cell's proxy, they always collide.
+	AddLayerInstance(CollisionLayer, Instance);
+
+	// Buildables never move, so an instance stays in the cell it was first shown in.
+	const FIntVector CellKey = GetProxyCellKey(Instance.Location);
+	FProxyCell& Cell = ProxyCells.FindOrAdd(CellKey);
+	if (InstanceProxyCells.Contains(Instance.Id))
+	{
+		FBuildableInstance* Piece = Cell.Pieces.FindByPredicate([&Instance](const FBuildableInstance& Existing) { return Existing.Id == Instance.Id; });
+		if (Piece != nullptr)
+		{
+			*Piece = Instance;
+		}
+	}
+	else
+	{
+		InstanceProxyCells.Add(Instance.Id, CellKey);
+		Cell.Pieces.Add(Instance);
+	}
+
+	if (Cell.bFar)
+	{
+		UpdateProxyInstance(CellKey);
+	}
+	else
+	{
+		AddLayerInstance(RenderLayer, Instance);
+	}
+}
+
+void ABuildableManager::UpdateInstanceStage(const FBuildableInstance& Instance)
+{
+	if (const FIntVector* CellKey = InstanceProxyCells.Find(Instance.Id))
+	{
+		AddLayerInstance(CollisionLayer, Instance);
 
+		// The cell's copy shows the new stage once the cell is near again. Proxies only depend on piece locations.
+		FProxyCell& Cell = ProxyCells.FindChecked(*CellKey);
+		if (FBuildableInstance* Piece = Cell.Pieces.FindByPredicate([&Instance](const FBuildableInstance& Existing) { return Existing.Id == Instance.Id; }))
+		{
+			*Piece = Instance;
+		}
+		if (Cell.bFar)
+		{
+			return;
+		}
+	}
 
-	ABuildable* tempBuildable = GetWorld()->SpawnActor<ABuildable>(BuildableFortification, Location, Rotation, SpawnParams);
-	tempBuildable->Place();
-	//tempBuildable->Build(90);
-	GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, TEXT("ABuildableManager::SpawnRequest"));
-	managedBuildables.Add(tempBuildable);
+	AddLayerInstance(RenderLayer, Instance);
 }
 
+void ABuildableManager::HideInstance(int32 Id)
+{
+	RemoveLayerInstance(RenderLayer, Id);
+	RemoveLayerInstance(CollisionLayer, Id);
+
+	FIntVector CellKey;
+	if (!InstanceProxyCells.RemoveAndCopyValue(Id, CellKey))
+	{
+		return;
+	}
+
+	FProxyCell& Cell = ProxyCells.FindChecked(CellKey);
+	Cell.Pieces.RemoveAllSwap([Id](const FBuildableInstance& Piece) { return Piece.Id == Id; });
+	if (Cell.bFar)
+	{
+		UpdateProxyInstance(CellKey);
+	}
+	if (Cell.Pieces.Num() == 0)
+	{
+		ProxyCells.Remove(CellKey);
+	}
+}
+
+bool ABuildableManager::UsesFarFieldProxies() const
+{
+	return GetNetMode() == NM_Client && ProxyMesh != nullptr;
+}
+
+FIntVector ABuildableManager::GetProxyCellKey(const FVector& Location) const
+{
+	// Cells are columns, a tall structure is one proxy.
+	return FIntVector(FMath::FloorToInt(Location.X / ProxyCellSize), FMath::FloorToInt(Location.Y / ProxyCellSize), 0);
+}
+
+void ABuildableManager::UpdateFarField()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildableManagerFarField);
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr)
+	{
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const float FarDistanceSq = FMath::Square(FarFieldDistance);
+	const float NearDistanceSq = FMath::Square(FarFieldDistance * 0.9f);
+
+	for (TPair<FIntVector, FProxyCell>& Entry : ProxyCells)
+	{
+		FProxyCell& Cell = Entry.Value;
+		const FVector CellCenter((Entry.Key.X + 0.5f) * ProxyCellSize, (Entry.Key.Y + 0.5f) * ProxyCellSize, ViewLocation.Z);
+		const float DistanceSq = FVector::DistSquared(CellCenter, ViewLocation);
+
+		if (!Cell.bFar && DistanceSq > FarDistanceSq)
+		{
+			INC_DWORD_STAT(STAT_BuildableFarFieldSwaps);
+			Cell.bFar = true;
+			for (const FBuildableInstance& Piece : Cell.Pieces)
+			{
+				RemoveLayerInstance(RenderLayer, Piece.Id);
+			}
+			UpdateProxyInstance(Entry.Key);
+		}
+		else if (Cell.bFar && DistanceSq < NearDistanceSq)
+		{
+			INC_DWORD_STAT(STAT_BuildableFarFieldSwaps);
+			Cell.bFar = false;
+			RemoveProxyInstance(Entry.Key);
+			for (const FBuildableInstance& Piece : Cell.Pieces)
+			{
+				AddLayerInstance(RenderLayer, Piece);
+			}
+		}
+	}
+}
+
+void ABuildableManager::UpdateProxyInstance(const FIntVector& CellKey)
+{
+	FProxyCell& Cell = ProxyCells.FindChecked(CellKey);
+	if (Cell.Pieces.Num() == 0)
+	{
+		RemoveProxyInstance(CellKey);
+		return;
+	}
+
+	FBox Bounds(ForceInit);
+	for (const FBuildableInstance& Piece : Cell.Pieces)
+	{
+		Bounds += Piece.Location;
+	}
+	Bounds = Bounds.ExpandBy(ProxyPadding);
+	const FTransform ProxyTransform(FQuat::Identity, Bounds.GetCenter(), Bounds.GetSize() / 100.0f);
+
+	if (ProxyComponent == nullptr)
+	{
+		ProxyComponent = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+		ProxyComponent->SetupAttachment(RootComponent);
+		ProxyComponent->SetMobility(EComponentMobility::Movable);
+		ProxyComponent->SetStaticMesh(ProxyMesh);
+		ProxyComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		ProxyComponent->RegisterComponent();
+	}
+
+	if (Cell.ProxyInstanceIndex != INDEX_NONE)
+	{
+		ProxyComponent->UpdateInstanceTransform(Cell.ProxyInstanceIndex, ProxyTransform, true, true);
+		return;
+	}
+
+	Cell.ProxyInstanceIndex = ProxyComponent->AddInstanceWorldSpace(ProxyTransform);
+	ProxyInstanceCells.SetNum(FMath::Max(ProxyInstanceCells.Num(), Cell.ProxyInstanceIndex + 1));
+	ProxyInstanceCells[Cell.ProxyInstanceIndex] = CellKey;
+	INC_DWORD_STAT(STAT_BuildableProxyCells);
+}
+
+void ABuildableManager::RemoveProxyInstance(const FIntVector& CellKey)
+{
+	FProxyCell& Cell = ProxyCells.FindChecked(CellKey);
+	if (Cell.ProxyInstanceIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 ProxyInstanceIndex = Cell.ProxyInstanceIndex;
+	Cell.ProxyInstanceIndex = INDEX_NONE;
+	ProxyComponent->RemoveInstance(ProxyInstanceIndex);
+	DEC_DWORD_STAT(STAT_BuildableProxyCells);
+
+	// Same swap-on-remove bookkeeping as the render components.
+	ProxyInstanceCells.RemoveAtSwap(ProxyInstanceIndex, 1, false);
+	if (ProxyInstanceCells.IsValidIndex(ProxyInstanceIndex))
+	{
+		ProxyCells.FindChecked(ProxyInstanceCells[ProxyInstanceIndex]).ProxyInstanceIndex = ProxyInstanceIndex;
+	}
+}
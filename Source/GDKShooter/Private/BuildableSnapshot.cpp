@@ -0,0 +1,151 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "BuildableSnapshot.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <WorkerSDK/improbable/c_schema.h>
+
+namespace
+{
+	// Bumped whenever the record layout changes, older data is then ignored rather than misread.
+	constexpr uint8 SnapshotVersion = 1;
+
+	constexpr Schema_FieldId ChunkDataFieldId = 1;
+}
+
+constexpr Worker_ComponentId FBuildableSnapshot::ChunkComponentId;
+constexpr int32 FBuildableSnapshot::RecordsPerChunk;
+
+FArchive& operator<<(FArchive& Ar, FBuildableSnapshotRecord& Record)
+{
+	uint16 Pitch = FRotator::CompressAxisToShort(Record.Rotation.Pitch);
+	uint16 Yaw = FRotator::CompressAxisToShort(Record.Rotation.Yaw);
+	uint16 Roll = FRotator::CompressAxisToShort(Record.Rotation.Roll);
+
+	Ar << Record.Location;
+	Ar << Pitch << Yaw << Roll;
+	Ar << Record.TypeIndex << Record.Stage << Record.TeamId << Record.QuantizedHealth;
+
+	if (Ar.IsLoading())
+	{
+		Record.Rotation = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), FRotator::DecompressAxisFromShort(Roll));
+	}
+	return Ar;
+}
+
+void FBuildableSnapshot::Serialize(FArchive& Ar)
+{
+	uint8 Version = SnapshotVersion;
+	Ar << Version;
+	if (Ar.IsLoading() && Version != SnapshotVersion)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << Types;
+
+	// Records are written back to back rather than as a TArray, so a corrupt count cannot trigger a huge allocation.
+	int32 NumRecords = Records.Num();
+	Ar << NumRecords;
+	if (Ar.IsLoading())
+	{
+		if (NumRecords < 0 || Ar.TotalSize() - Ar.Tell() < NumRecords)
+		{
+			Ar.SetError();
+			return;
+		}
+		Records.SetNum(NumRecords);
+	}
+	for (FBuildableSnapshotRecord& Record : Records)
+	{
+		Ar << Record;
+	}
+}
+
+FString FBuildableSnapshot::GetSaveFilePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Buildables") / TEXT("Buildables.bin");
+}
+
+bool FBuildableSnapshot::SaveToFile() const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	const_cast<FBuildableSnapshot*>(this)->Serialize(Writer);
+	return FFileHelper::SaveArrayToFile(Bytes, *GetSaveFilePath());
+}
+
+bool FBuildableSnapshot::LoadFromFile()
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetSaveFilePath(), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+	return !Reader.IsError();
+}
+
+void FBuildableSnapshot::SplitIntoChunks(TArray<FBuildableSnapshot>& OutChunks) const
+{
+	for (int32 First = 0; First < Records.Num(); First += RecordsPerChunk)
+	{
+		FBuildableSnapshot& Chunk = OutChunks.AddDefaulted_GetRef();
+		Chunk.Types = Types;
+		Chunk.Records.Append(Records.GetData() + First, FMath::Min(RecordsPerChunk, Records.Num() - First));
+	}
+}
+
+void FBuildableSnapshot::Append(const FBuildableSnapshot& Other)
+{
+	TArray<uint8, TInlineAllocator<16>> TypeRemap;
+	for (const FString& Type : Other.Types)
+	{
+		TypeRemap.Add(static_cast<uint8>(Types.AddUnique(Type)));
+	}
+
+	Records.Reserve(Records.Num() + Other.Records.Num());
+	for (const FBuildableSnapshotRecord& Record : Other.Records)
+	{
+		if (TypeRemap.IsValidIndex(Record.TypeIndex))
+		{
+			FBuildableSnapshotRecord& Added = Records.Add_GetRef(Record);
+			Added.TypeIndex = TypeRemap[Record.TypeIndex];
+		}
+	}
+}
+
+void FBuildableSnapshot::WriteChunkComponent(Schema_Object* ComponentFields) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	const_cast<FBuildableSnapshot*>(this)->Serialize(Writer);
+
+	// The schema object owns the copy, Bytes goes out of scope before the component is written.
+	uint8* Buffer = Schema_AllocateBuffer(ComponentFields, Bytes.Num());
+	FMemory::Memcpy(Buffer, Bytes.GetData(), Bytes.Num());
+	Schema_AddBytes(ComponentFields, ChunkDataFieldId, Buffer, Bytes.Num());
+}
+
+bool FBuildableSnapshot::ReadChunkComponent(Schema_Object* ComponentFields)
+{
+	if (Schema_GetBytesCount(ComponentFields, ChunkDataFieldId) == 0)
+	{
+		return false;
+	}
+
+	const uint32 Length = Schema_GetBytesLength(ComponentFields, ChunkDataFieldId);
+	const uint8* Data = Schema_GetBytes(ComponentFields, ChunkDataFieldId);
+	TArray<uint8> Bytes(Data, Length);
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+	return !Reader.IsError();
+}
@@ -0,0 +1,133 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "BuildableSupportGraph.h"
+
+void FBuildableSupportGraph::Add(int32 Id, bool bGrounded, TArrayView<const int32> Neighbours)
+{
+	FNode& Node = Nodes.Add(Id);
+	Node.bGrounded = bGrounded;
+
+	bool bTouchesSearch = false;
+	for (int32 Neighbour : Neighbours)
+	{
+		if (FNode* NeighbourNode = Nodes.Find(Neighbour))
+		{
+			if (Neighbour != Id)
+			{
+				Node.Neighbours.Add(Neighbour);
+				NeighbourNode->Neighbours.Add(Id);
+				bTouchesSearch |= SearchVisited.Contains(Neighbour);
+			}
+		}
+	}
+
+	// The search may already have expanded that neighbour and would miss the new path, so it starts over.
+	if (bTouchesSearch)
+	{
+		Suspects.Add(SearchRoot);
+		EndSearch();
+	}
+}
+
+void FBuildableSupportGraph::Remove(int32 Id)
+{
+	FNode Node;
+	if (!Nodes.RemoveAndCopyValue(Id, Node))
+	{
+		return;
+	}
+
+	for (int32 Neighbour : Node.Neighbours)
+	{
+		if (FNode* NeighbourNode = Nodes.Find(Neighbour))
+		{
+			NeighbourNode->Neighbours.RemoveSingleSwap(Id, false);
+			if (!NeighbourNode->bGrounded)
+			{
+				Suspects.Add(Neighbour);
+			}
+		}
+	}
+}
+
+void FBuildableSupportGraph::Update(int32 MaxVisits, TArray<int32>& OutUnsupported)
+{
+	int32 Visits = 0;
+	while (Visits < MaxVisits)
+	{
+		if (!bSearching)
+		{
+			if (Suspects.Num() == 0)
+			{
+				return;
+			}
+
+			const int32 Suspect = Suspects.Pop(false);
+			if (Nodes.Contains(Suspect))
+			{
+				StartSearch(Suspect);
+			}
+			continue;
+		}
+
+		if (SearchFrontier.Num() == 0)
+		{
+			// Everything reachable from the root has been visited without finding the ground, so it all falls.
+			for (int32 Id : SearchVisited)
+			{
+				if (Nodes.Remove(Id) > 0)
+				{
+					OutUnsupported.Add(Id);
+				}
+			}
+			EndSearch();
+			continue;
+		}
+
+		Visits++;
+		const FNode* Node = Nodes.Find(SearchFrontier.Pop(false));
+		if (Node == nullptr)
+		{
+			continue;
+		}
+
+		if (Node->bGrounded)
+		{
+			EndSearch();
+			continue;
+		}
+
+		for (int32 Neighbour : Node->Neighbours)
+		{
+			bool bAlreadyVisited;
+			SearchVisited.Add(Neighbour, &bAlreadyVisited);
+			if (!bAlreadyVisited)
+			{
+				SearchFrontier.Add(Neighbour);
+			}
+		}
+	}
+}
+
+void FBuildableSupportGraph::Reset()
+{
+	Nodes.Reset();
+	Suspects.Reset();
+	EndSearch();
+}
+
+void FBuildableSupportGraph::StartSearch(int32 Root)
+{
+	bSearching = true;
+	SearchRoot = Root;
+	SearchVisited.Add(Root);
+	SearchFrontier.Add(Root);
+}
+
+void FBuildableSupportGraph::EndSearch()
+{
+	bSearching = false;
+	SearchRoot = INDEX_NONE;
+	SearchVisited.Reset();
+	SearchFrontier.Reset();
+}
@@ -6,6 +6,7 @@
 #include "GameFramework/Controller.h"
 #include "Net/UnrealNetwork.h"
 #include "GDKLogging.h"
+#include "Systems/GDKComponentRegistry.h"
 
 // Use the first custom movement flag slot in the character for sprinting.
 static const FSavedMove_Character::CompressedFlags FLAG_WantsToSprint = FSavedMove_GDKMovement::FLAG_Custom_0;
@@ -32,6 +33,18 @@ UGDKMovementComponent::UGDKMovementComponent(const FObjectInitializer& ObjectIni
 	SetIsReplicatedByDefault(true);
 }
 
+void UGDKMovementComponent::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UGDKMovementComponent::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
+}
+
 void UGDKMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
@@ -9,6 +9,10 @@
 #include "Controllers/Components/ControllerEventsComponent.h"
 #include "Game/Components/ScorePublisher.h"
 #include "Characters/Components/TeamComponent.h"
+#include "Systems/DamageSubsystem.h"
+#include "Systems/GDKComponentRegistry.h"
+#include "Systems/RadialDamageSubsystem.h"
+#include "Systems/RegenerationSubsystem.h"
 
 UHealthComponent::UHealthComponent()
 {
@@ -27,6 +31,19 @@ UHealthComponent::UHealthComponent()
 		MaxArmour = 100.f;
 	}
 	CurrentArmour = 0.f;
+	UpdateQuantizedValues();
+}
+
+void UHealthComponent::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UHealthComponent::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
 }
 
 
@@ -38,6 +55,20 @@ void UHealthComponent::BeginPlay()
 	{
 		CurrentHealth = startHealth;
 		CurrentArmour = 0.f;
+		UpdateQuantizedValues();
+	}
+
+	if (GetNetMode() != NM_Client)
+	{
+		if (URadialDamageSubsystem* RadialDamage = GetWorld()->GetSubsystem<URadialDamageSubsystem>())
+		{
+			RadialDamage->RegisterDamageable(this);
+		}
+
+		if (URegenerationSubsystem* Regeneration = GetWorld()->GetSubsystem<URegenerationSubsystem>())
+		{
+			Regeneration->RegisterRegeneration(this, GetRegenerationRates());
+		}
 	}
 }
 
@@ -45,138 +76,216 @@ void UHealthComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Out
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UHealthComponent, CurrentHealth);
+	// Only the owning client needs exact values, everyone else gets a 7-bit bucket for health bars.
+	DOREPLIFETIME_CONDITION(UHealthComponent, CurrentHealth, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(UHealthComponent, CurrentArmour, COND_OwnerOnly);
 
-	DOREPLIFETIME(UHealthComponent, CurrentArmour);
+	DOREPLIFETIME_CONDITION(UHealthComponent, QuantizedHealth, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(UHealthComponent, QuantizedArmour, COND_SkipOwner);
 }
 
 void UHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	if (GetOwner()->GetWorldTimerManager().IsTimerActive(HealthRegenerationHandle))
+	if (URadialDamageSubsystem* RadialDamage = GetWorld()->GetSubsystem<URadialDamageSubsystem>())
 	{
-		GetOwner()->GetWorldTimerManager().ClearTimer(HealthRegenerationHandle);
+		RadialDamage->UnregisterDamageable(this);
 	}
 
-	if (GetOwner()->GetWorldTimerManager().IsTimerActive(ArmourRegenerationHandle))
+	if (URegenerationSubsystem* Regeneration = GetWorld()->GetSubsystem<URegenerationSubsystem>())
 	{
-		GetOwner()->GetWorldTimerManager().ClearTimer(ArmourRegenerationHandle);
+		Regeneration->UnregisterRegeneration(this);
 	}
 }
 
 void UHealthComponent::TakeDamage(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	if (UTeamComponent* Team = Cast<UTeamComponent>(GetOwner()->GetComponentByClass(UTeamComponent::StaticClass())))
-	{
-		if (EventInstigator && !Team->CanDamageActor(EventInstigator->GetPawn()))
-		{
-			return;
-		}
-	}
+	FDamageRecord Record;
+	Record.Victim = this;
+	Record.Instigator = EventInstigator;
+	Record.DamageCauser = DamageCauser;
+	Record.Damage = Damage;
 
-	int32 ArmourRemoved = FMath::Min(Damage, CurrentArmour);
-	CurrentArmour -= ArmourRemoved;
-	int32 DamageDealt = FMath::Min(Damage - ArmourRemoved, CurrentHealth);
-	bool bWasDead = CurrentHealth <= 0.f;
-	CurrentHealth -= DamageDealt;
-	bool bIsDead = CurrentHealth <= 0.f;
-
-	int32 InstigatorPlayerId = -1;
-	FGenericTeamId InstigatorTeamId = FGenericTeamId::NoTeam;
-	if (EventInstigator != nullptr)
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
 	{
-		APlayerState* InstigatorPlayerState = EventInstigator->PlayerState;
-		if (InstigatorPlayerState != nullptr)
-		{
-#if ENGINE_MINOR_VERSION <= 24
-			InstigatorPlayerId = InstigatorPlayerState->PlayerId;
-#else
-			InstigatorPlayerId = InstigatorPlayerState->GetPlayerId();
-#endif
-			if (const UTeamComponent* TeamComponent = InstigatorPlayerState->FindComponentByClass<UTeamComponent>())
-			{
-				InstigatorTeamId = TeamComponent->GetTeam();
-			}
-		}
+		FPointDamageEvent* const PointDamageEvent = (FPointDamageEvent*)&DamageEvent;
+		Record.Source = DamageCauser ? DamageCauser->GetActorLocation() : GetOwner()->GetActorLocation() - PointDamageEvent->ShotDirection;
+		Record.Impact = PointDamageEvent->HitInfo.ImpactPoint;
 	}
-	if (IGenericTeamAgentInterface* InstgatorTeam = Cast<IGenericTeamAgentInterface>(EventInstigator))
+	else if (DamageEvent.IsOfType(FRadialDamageEvent::ClassID))
 	{
-		InstigatorTeamId = InstgatorTeam->GetGenericTeamId();
+		FRadialDamageEvent* const RadialDamageEvent = (FRadialDamageEvent*)&DamageEvent;
+		Record.Impact = GetOwner()->GetActorLocation() + RadialDamageImpactOffset;
+		Record.Source = RadialDamageEvent->Origin;
 	}
-	else if (IGenericTeamAgentInterface* CauserTeam = Cast<IGenericTeamAgentInterface>(DamageCauser))
+	else
 	{
-		InstigatorTeamId = CauserTeam->GetGenericTeamId();
+		Record.Source = DamageCauser ? DamageCauser->GetActorLocation() : GetOwner()->GetActorLocation();
+		Record.Impact = GetOwner()->GetActorLocation();
 	}
 
-	FVector Source;
-	FVector Impact;
+	if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(MoveTemp(Record));
+		return;
+	}
 
-	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	if (ResolveDamage(MakeArrayView(&Record, 1)) != INDEX_NONE)
 	{
-		FPointDamageEvent* const PointDamageEvent = (FPointDamageEvent*)&DamageEvent;
-		Source = DamageCauser ? DamageCauser->GetActorLocation() : GetOwner()->GetActorLocation() - PointDamageEvent->ShotDirection;
-		Impact = PointDamageEvent->HitInfo.ImpactPoint;
+		HandleDeath(EventInstigator);
 	}
-	else if (DamageEvent.IsOfType(FRadialDamageEvent::ClassID))
+}
+
+int32 UHealthComponent::ResolveDamage(TArrayView<const FDamageRecord> Records)
+{
+	UTeamComponent* Team = UGDKComponentRegistry::Find<UTeamComponent>(GetOwner());
+
+	int32 KillingRecord = INDEX_NONE;
+	bool bTookNonLethalDamage = false;
+	AController* LastInstigator = nullptr;
+
+	// Consecutive hits usually share an instigator, so everything derived from it is only worked out when it changes:
+	// its ids, whether it may damage this team, and where its damage dealt feedback goes.
+	const AController* CachedInstigator = nullptr;
+	const AActor* CachedCauser = nullptr;
+	int32 InstigatorPlayerId = -1;
+	FGenericTeamId InstigatorTeamId = FGenericTeamId::NoTeam;
+	bool bInstigatorCanDamage = true;
+	UControllerEventsComponent* InstigatorEvents = nullptr;
+
+	// Feedback for the whole batch goes out in one flush next frame.
+	const bool bFlushScheduled = PendingDamageFeedback.Num() > 0;
+	PendingDamageFeedback.Reserve(PendingDamageFeedback.Num() + Records.Num());
+
+	for (int32 i = 0; i < Records.Num(); i++)
 	{
-		FRadialDamageEvent* const RadialDamageEvent = (FRadialDamageEvent*)&DamageEvent;
-		Impact = GetOwner()->GetActorLocation() + RadialDamageImpactOffset;
-		Source = RadialDamageEvent->Origin;
+		const FDamageRecord& Record = Records[i];
+		AController* EventInstigator = Record.Instigator.Get();
+		AActor* DamageCauser = Record.DamageCauser.Get();
+
+		if (i == 0 || EventInstigator != CachedInstigator || DamageCauser != CachedCauser)
+		{
+			CachedInstigator = EventInstigator;
+			CachedCauser = DamageCauser;
+			GetInstigatorIds(EventInstigator, DamageCauser, InstigatorPlayerId, InstigatorTeamId);
+			bInstigatorCanDamage = !Team || !EventInstigator || Team->CanDamageActor(EventInstigator->GetPawn());
+			InstigatorEvents = EventInstigator ? UGDKComponentRegistry::Find<UControllerEventsComponent>(EventInstigator) : nullptr;
+		}
+
+		if (!bInstigatorCanDamage)
+		{
+			continue;
+		}
+
+		int32 ArmourRemoved = FMath::Min(Record.Damage, CurrentArmour);
+		CurrentArmour -= ArmourRemoved;
+		int32 DamageDealt = FMath::Min(Record.Damage - ArmourRemoved, CurrentHealth);
+		bool bWasDead = CurrentHealth <= 0.f;
+		CurrentHealth -= DamageDealt;
+		bool bIsDead = CurrentHealth <= 0.f;
+
+		FDamageFeedback& Feedback = PendingDamageFeedback.AddDefaulted_GetRef();
+		Feedback.Value = Record.Damage;
+		Feedback.Source = Record.Source;
+		Feedback.Impact = Record.Impact;
+		Feedback.InstigatorPlayerId = InstigatorPlayerId;
+		Feedback.InstigatorTeamId = InstigatorTeamId;
+
+		if (InstigatorEvents != nullptr)
+		{
+			FDamageDealtFeedback Dealt;
+			Dealt.Victim = GetOwner();
+			Dealt.Value = Record.Damage;
+			Dealt.Impact = Record.Impact;
+			InstigatorEvents->QueueDamageDealt(Dealt);
+		}
+
+		if (!bWasDead && bIsDead)
+		{
+			KillingRecord = i;
+		}
+		else if (!bIsDead)
+		{
+			bTookNonLethalDamage = true;
+			LastInstigator = EventInstigator;
+		}
 	}
-	else
+
+	if (!bFlushScheduled && PendingDamageFeedback.Num() > 0)
 	{
-		Source = DamageCauser ? DamageCauser->GetActorLocation() : GetOwner()->GetActorLocation();
-		Impact = GetOwner()->GetActorLocation();
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UHealthComponent::FlushDamageFeedback);
 	}
 
-	MulticastDamageTaken(Damage, Source, Impact, InstigatorPlayerId, InstigatorTeamId);
+	UpdateQuantizedValues();
 
-	if (!bWasDead && bIsDead)
+	if (bTookNonLethalDamage)
 	{
-		AuthoritativeDeath.Broadcast(EventInstigator);
+		if (CurrentHealth > 0.f)
+		{
+			if (URegenerationSubsystem* Regeneration = GetWorld()->GetSubsystem<URegenerationSubsystem>())
+			{
+				Regeneration->NotifyDamaged(this, GetRegenerationRates());
+			}
+		}
+
+		AuthoritativeDamage.Broadcast(LastInstigator);
+	}
+
+	return KillingRecord;
+}
 
-		if (APawn* OwnerAsPawn = Cast<APawn>(GetOwner()))
+void UHealthComponent::HandleDeath(AController* EventInstigator)
+{
+	AuthoritativeDeath.Broadcast(EventInstigator);
+
+	if (APawn* OwnerAsPawn = Cast<APawn>(GetOwner()))
+	{
+		if (AController* Controller = OwnerAsPawn->GetController())
 		{
-			if (AController* Controller = OwnerAsPawn->GetController())
+			if (UControllerEventsComponent* ControllerEvents = UGDKComponentRegistry::Find<UControllerEventsComponent>(Controller))
 			{
-				if (UControllerEventsComponent* ControllerEvents = Cast<UControllerEventsComponent>(Controller->GetComponentByClass(UControllerEventsComponent::StaticClass())))
-				{
-					ControllerEvents->Death(EventInstigator);
-				}
+				ControllerEvents->Death(EventInstigator);
+			}
 
-				if (EventInstigator != nullptr)
+			if (EventInstigator != nullptr)
+			{
+				if (UControllerEventsComponent* ControllerEvents = UGDKComponentRegistry::Find<UControllerEventsComponent>(EventInstigator))
 				{
-					if (UControllerEventsComponent* ControllerEvents = Cast<UControllerEventsComponent>(EventInstigator->GetComponentByClass(UControllerEventsComponent::StaticClass())))
-					{
-						ControllerEvents->Kill(Controller);
-					}
+					ControllerEvents->Kill(Controller);
 				}
 			}
 		}
 	}
+}
 
-
-	if(!bIsDead)
+void UHealthComponent::GetInstigatorIds(AController* EventInstigator, AActor* DamageCauser, int32& OutPlayerId, FGenericTeamId& OutTeamId)
+{
+	OutPlayerId = -1;
+	OutTeamId = FGenericTeamId::NoTeam;
+	if (EventInstigator != nullptr)
 	{
-		if (GetOwner()->GetWorldTimerManager().IsTimerActive(HealthRegenerationHandle))
-		{
-			GetOwner()->GetWorldTimerManager().ClearTimer(HealthRegenerationHandle);
-		}
-		if (GetOwner()->GetWorldTimerManager().IsTimerActive(ArmourRegenerationHandle))
-		{
-			GetOwner()->GetWorldTimerManager().ClearTimer(ArmourRegenerationHandle);
-		}
-		if (HealthRegenInterval > 0)
-		{
-			GetOwner()->GetWorldTimerManager().SetTimer(HealthRegenerationHandle, this, &UHealthComponent::RegenerateHealth, HealthRegenInterval, true, HealthRegenCooldown);
-		}
-		if (ArmourRegenInterval > 0)
+		APlayerState* InstigatorPlayerState = EventInstigator->PlayerState;
+		if (InstigatorPlayerState != nullptr)
 		{
-			GetOwner()->GetWorldTimerManager().SetTimer(ArmourRegenerationHandle, this, &UHealthComponent::RegenerateArmour, ArmourRegenInterval, true, ArmourRegenCooldown);
+#if ENGINE_MINOR_VERSION <= 24
+			OutPlayerId = InstigatorPlayerState->PlayerId;
+#else
+			OutPlayerId = InstigatorPlayerState->GetPlayerId();
+#endif
+			if (const UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(InstigatorPlayerState))
+			{
+				OutTeamId = TeamComponent->GetTeam();
+			}
 		}
-
-		AuthoritativeDamage.Broadcast(EventInstigator);
+	}
+	if (IGenericTeamAgentInterface* InstgatorTeam = Cast<IGenericTeamAgentInterface>(EventInstigator))
+	{
+		OutTeamId = InstgatorTeam->GetGenericTeamId();
+	}
+	else if (IGenericTeamAgentInterface* CauserTeam = Cast<IGenericTeamAgentInterface>(DamageCauser))
+	{
+		OutTeamId = CauserTeam->GetGenericTeamId();
 	}
 }
 
@@ -185,6 +294,7 @@ bool UHealthComponent::GrantHealth(float Value)
 	if (CurrentHealth < MaxHealth)
 	{
 		CurrentHealth = FMath::Min(CurrentHealth + Value, MaxHealth);
+		UpdateQuantizedValues();
 
 		return true;
 	}
@@ -197,6 +307,7 @@ bool UHealthComponent::GrantShield(float Value)
 	if (CurrentArmour < MaxArmour)
 	{
 		CurrentArmour = FMath::Min(CurrentArmour + Value, MaxArmour);
+		UpdateQuantizedValues();
 
 		return true;
 	}
@@ -204,20 +315,33 @@ bool UHealthComponent::GrantShield(float Value)
 	return false;
 }
 
-void UHealthComponent::RegenerateHealth()
+void UHealthComponent::Regenerate(float HealthValue, float ArmourValue)
 {
-	if (CurrentHealth > 0.f)
+	if (CurrentHealth <= 0.f)
 	{
-		GrantHealth(HealthRegenValue);
+		return;
 	}
-}
 
-void UHealthComponent::RegenerateArmour()
-{
-	if (CurrentArmour > 0.f)
+	if (HealthValue > 0.f)
 	{
-		GrantHealth(ArmourRegenValue);
+		GrantHealth(HealthValue);
 	}
+	if (ArmourValue > 0.f)
+	{
+		GrantShield(ArmourValue);
+	}
+}
+
+FRegenerationRates UHealthComponent::GetRegenerationRates() const
+{
+	FRegenerationRates Rates;
+	Rates.HealthValue = HealthRegenValue;
+	Rates.HealthCooldown = HealthRegenCooldown;
+	Rates.HealthInterval = HealthRegenInterval;
+	Rates.ArmourValue = ArmourRegenValue;
+	Rates.ArmourCooldown = ArmourRegenCooldown;
+	Rates.ArmourInterval = ArmourRegenInterval;
+	return Rates;
 }
 
 void UHealthComponent::OnRep_CurrentArmour()
@@ -234,7 +358,83 @@ void UHealthComponent::OnRep_CurrentHealth()
 	}
 }
 
-void UHealthComponent::MulticastDamageTaken_Implementation(float Value, FVector Source, FVector Impact, int32 InstigatorPlayerId, FGenericTeamId InstigatorTeamId)
+uint8 UHealthComponent::Quantize(float Value, float Max)
 {
-	DamageTaken.Broadcast(Value, Source, Impact, InstigatorPlayerId, InstigatorTeamId);
+	// Rounded up so that only an exact zero maps to zero, and death is never hidden by quantization.
+	return Max > 0.f ? (uint8)FMath::Clamp(FMath::CeilToInt(Value / Max * QuantizedMax), 0, (int32)QuantizedMax) : 0;
+}
+
+float UHealthComponent::Dequantize(uint8 Value, float Max)
+{
+	return (float)Value / QuantizedMax * Max;
+}
+
+void UHealthComponent::UpdateQuantizedValues()
+{
+	QuantizedHealth = Quantize(CurrentHealth, MaxHealth);
+	QuantizedArmour = Quantize(CurrentArmour, MaxArmour);
+}
+
+void UHealthComponent::OnRep_QuantizedHealth()
+{
+	// Non-owning clients never receive CurrentHealth, so keep it approximated for the getters.
+	CurrentHealth = Dequantize(QuantizedHealth, MaxHealth);
+	OnRep_CurrentHealth();
+}
+
+void UHealthComponent::OnRep_QuantizedArmour()
+{
+	CurrentArmour = Dequantize(QuantizedArmour, MaxArmour);
+	OnRep_CurrentArmour();
+}
+
+void UHealthComponent::FlushDamageFeedback()
+{
+	if (PendingDamageFeedback.Num() == 0)
+	{
+		return;
+	}
+
+	ClientDamageTaken(PendingDamageFeedback);
+
+	// Without an owning client the multicast is the only way DamageTaken fires anywhere, so it is never throttled.
+	const bool bHasOwningClient = GetOwner()->GetNetConnection() != nullptr;
+	if (SpectatorDamageInterval > 0.0f || !bHasOwningClient)
+	{
+		for (const FDamageFeedback& Feedback : PendingDamageFeedback)
+		{
+			PendingSpectatorDamage += Feedback.Value;
+		}
+
+		const float Now = GetWorld()->GetTimeSeconds();
+		if (!bHasOwningClient || Now - LastSpectatorDamageTime >= SpectatorDamageInterval)
+		{
+			const FDamageFeedback& Latest = PendingDamageFeedback.Last();
+			MulticastCoarseDamageTaken(PendingSpectatorDamage, Latest.Source, Latest.Impact);
+			PendingSpectatorDamage = 0.0f;
+			LastSpectatorDamageTime = Now;
+		}
+	}
+
+	PendingDamageFeedback.Reset();
+}
+
+void UHealthComponent::ClientDamageTaken_Implementation(const TArray<FDamageFeedback>& Feedback)
+{
+	for (const FDamageFeedback& Entry : Feedback)
+	{
+		DamageTaken.Broadcast(Entry.Value, Entry.Source, Entry.Impact, Entry.InstigatorPlayerId, Entry.InstigatorTeamId);
+	}
+}
+
+void UHealthComponent::MulticastCoarseDamageTaken_Implementation(float Value, FVector_NetQuantize Source, FVector_NetQuantize Impact)
+{
+	// The owning client has already been told about each hit individually.
+	const APawn* OwnerAsPawn = Cast<APawn>(GetOwner());
+	if (GetNetMode() == NM_DedicatedServer || (OwnerAsPawn && OwnerAsPawn->IsLocallyControlled()))
+	{
+		return;
+	}
+
+	DamageTaken.Broadcast(Value, Source, Impact, -1, FGenericTeamId::NoTeam);
 }
@@ -3,12 +3,25 @@
 #include "Characters/Components/MetaDataComponent.h"
 #include "Net/UnrealNetwork.h"
 #include "GDKLogging.h"
+#include "Systems/GDKComponentRegistry.h"
 
 UMetaDataComponent::UMetaDataComponent()
 {
 	SetIsReplicatedByDefault(true);
 }
 
+void UMetaDataComponent::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UMetaDataComponent::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
+}
+
 void UMetaDataComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
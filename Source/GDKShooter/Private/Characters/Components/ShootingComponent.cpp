@@ -1,10 +1,15 @@
 // Copyright (c) Improbable Worlds Ltd, All Rights Reserved
 
 #include "Characters/Components/ShootingComponent.h"
+#include "BuildableManager.h"
 #include "CollisionQueryParams.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
 #include "GDKLogging.h"
+#include "GDKStats.h"
+#include "Systems/GDKComponentRegistry.h"
+
+DECLARE_CYCLE_STAT(TEXT("ShootingComponent LineTrace"), STAT_ShootingLineTrace, STATGROUP_GDKShooter);
 
 UShootingComponent::UShootingComponent()
 {
@@ -13,6 +18,18 @@ UShootingComponent::UShootingComponent()
 	MaxRange = 50000.0f;
 }
 
+void UShootingComponent::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UShootingComponent::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
+}
+
 void UShootingComponent::BeginPlay()
 {
 	Super::BeginPlay();
@@ -39,12 +56,17 @@ void UShootingComponent::BeginPlay()
 }
 
 
-FInstantHitInfo UShootingComponent::DoLineTrace(FVector Direction, AActor* ActorToIgnore)
+void UShootingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	FInstantHitInfo OutHitInfo;
-	
-	FCollisionQueryParams TraceParams;
-	TraceParams.bTraceComplex = true;
+	Super::EndPlay(EndPlayReason);
+
+	// Outstanding async traces are bound to this component and will be dropped by the engine.
+	PendingTraceBatches.Empty();
+}
+
+FCollisionQueryParams UShootingComponent::MakeTraceParams(AActor* ActorToIgnore) const
+{
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ShootingLineTrace), bTraceComplex);
 	TraceParams.bReturnPhysicalMaterial = false;
 	if (ActorToIgnore != nullptr)
 	{
@@ -55,6 +77,35 @@ FInstantHitInfo UShootingComponent::DoLineTrace(FVector Direction, AActor* Actor
 			TraceParams.AddIgnoredActor(ActorToIgnoresOwner);
 		}
 	}
+	return TraceParams;
+}
+
+FInstantHitInfo UShootingComponent::MakeHitInfo(bool bDidHit, const FHitResult& HitResult, const FVector& TraceEnd)
+{
+	FInstantHitInfo OutHitInfo;
+
+	if (!bDidHit)
+	{
+		OutHitInfo.Location = TraceEnd;
+		return OutHitInfo;
+	}
+
+	OutHitInfo.Location = HitResult.ImpactPoint;
+	OutHitInfo.HitActor = HitResult.GetActor();
+
+	if (const ABuildableManager* BuildableManager = Cast<ABuildableManager>(OutHitInfo.HitActor))
+	{
+		OutHitInfo.HitItem = BuildableManager->GetHitBuildableId(HitResult);
+	}
+
+	OutHitInfo.bDidHit = true;
+
+	return OutHitInfo;
+}
+
+FInstantHitInfo UShootingComponent::DoLineTrace(FVector Direction, AActor* ActorToIgnore)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShootingLineTrace);
 
 	FHitResult HitResult(ForceInit);
 	FVector TraceStart = GetLineTraceStart();
@@ -65,18 +116,73 @@ FInstantHitInfo UShootingComponent::DoLineTrace(FVector Direction, AActor* Actor
 		TraceStart,
 		TraceEnd,
 		TraceChannel,
-		TraceParams);
+		MakeTraceParams(ActorToIgnore));
 
-	if (!bDidHit)
+	return MakeHitInfo(bDidHit, HitResult, TraceEnd);
+}
+
+void UShootingComponent::DoLineTraceBatch(const TArray<FVector>& Directions, AActor* ActorToIgnore, const FInstantHitBatchDelegate& OnComplete, bool bSynchronous)
+{
+	if (Directions.Num() == 0)
 	{
-		OutHitInfo.Location = TraceEnd;
-		return OutHitInfo;
+		OnComplete.ExecuteIfBound(TArray<FInstantHitInfo>());
+		return;
 	}
 
-	OutHitInfo.Location = HitResult.ImpactPoint;
-	OutHitInfo.HitActor = HitResult.GetActor();
+	if (bSynchronous)
+	{
+		TArray<FInstantHitInfo> Results;
+		Results.Reserve(Directions.Num());
+		for (const FVector& Direction : Directions)
+		{
+			Results.Add(DoLineTrace(Direction, ActorToIgnore));
+		}
+		OnComplete.ExecuteIfBound(Results);
+		return;
+	}
 
-	OutHitInfo.bDidHit = true;
+	const uint32 BatchId = NextTraceBatchId++;
+	FPendingTraceBatch& Batch = PendingTraceBatches.Add(BatchId);
+	Batch.Results.SetNum(Directions.Num());
+	Batch.Remaining = Directions.Num();
+	Batch.OnComplete = OnComplete;
 
-	return OutHitInfo;
+	const FCollisionQueryParams TraceParams = MakeTraceParams(ActorToIgnore);
+	const FVector TraceStart = GetLineTraceStart();
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UShootingComponent::OnBatchTraceCompleted, BatchId);
+
+	for (int32 i = 0; i < Directions.Num(); i++)
+	{
+		// The ray index travels as the trace's user data so results can be written back in request order.
+		GetWorld()->AsyncLineTraceByChannel(
+			EAsyncTraceType::Single,
+			TraceStart,
+			TraceStart + Directions[i] * MaxRange,
+			TraceChannel,
+			TraceParams,
+			FCollisionResponseParams::DefaultResponseParam,
+			&TraceDelegate,
+			static_cast<uint32>(i));
+	}
+}
+
+void UShootingComponent::OnBatchTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 BatchId)
+{
+	FPendingTraceBatch* Batch = PendingTraceBatches.Find(BatchId);
+	if (Batch == nullptr || !Batch->Results.IsValidIndex(Datum.UserData))
+	{
+		return;
+	}
+
+	const bool bDidHit = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+	Batch->Results[Datum.UserData] = MakeHitInfo(bDidHit, bDidHit ? Datum.OutHits[0] : FHitResult(ForceInit), Datum.End);
+
+	if (--Batch->Remaining > 0)
+	{
+		return;
+	}
+
+	FPendingTraceBatch CompletedBatch = MoveTemp(*Batch);
+	PendingTraceBatches.Remove(BatchId);
+	CompletedBatch.OnComplete.ExecuteIfBound(CompletedBatch.Results);
 }
@@ -3,6 +3,7 @@
 #include "Characters/Components/TeamComponent.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/World.h"
+#include "Systems/GDKComponentRegistry.h"
 
 
 UTeamComponent::UTeamComponent()
@@ -11,6 +12,18 @@ UTeamComponent::UTeamComponent()
 	SetIsReplicatedByDefault(true);
 }
 
+void UTeamComponent::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UTeamComponent::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
+}
+
 void UTeamComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -35,7 +48,7 @@ bool UTeamComponent::CanDamageActor(AActor* OtherActor)
 		return true;
 	}
 
-	if (UTeamComponent* OtherTeamComponent = Cast<UTeamComponent>(OtherActor->GetComponentByClass(UTeamComponent::StaticClass())))
+	if (UTeamComponent* OtherTeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(OtherActor))
 	{
 		return !OtherTeamComponent->HasTeam() || OtherTeamComponent->GetTeam() != GetTeam();
 	}
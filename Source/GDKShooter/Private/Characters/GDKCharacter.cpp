@@ -11,13 +11,23 @@
 #include "Controllers/GDKPlayerController.h"
 #include "Controllers/Components/ControllerEventsComponent.h"
 #include "Weapons/Holdable.h"
+#include "Weapons/HitboxCollision.h"
 #include "BuildManagerComponent.h"
+#include "Systems/DamageSubsystem.h"
 
 AGDKCharacter::AGDKCharacter(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer.SetDefaultSubobjectClass<UGDKMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
+
+	// Weapon traces only hit the hitbox, never the movement capsule or the skeletal mesh.
+	Hitbox = CreateDefaultSubobject<UCapsuleComponent>(TEXT("Hitbox"));
+	Hitbox->SetupAttachment(GetCapsuleComponent());
+	Hitbox->InitCapsuleSize(36.f, 96.0f - HitboxHeightInset);
+	HitboxCollision::ConfigureHitbox(Hitbox);
+	HitboxCollision::IgnoreWeaponTraces(GetCapsuleComponent());
+	HitboxCollision::IgnoreWeaponTraces(GetMesh());
 	
 	HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("Health"));
 	EquippedComponent = CreateDefaultSubobject<UEquippedComponent>(TEXT("Equipment"));
@@ -107,6 +117,21 @@ void AGDKCharacter::MoveRight(float Value)
 	}
 }
 
+void AGDKCharacter::OnStartCrouch(float HalfHeightAdjust, float ScaledHalfHeightAdjust)
+{
+	Super::OnStartCrouch(HalfHeightAdjust, ScaledHalfHeightAdjust);
+
+	// The capsule has shrunk and the actor has moved down with it, so shrink the hitbox to keep it off the floor.
+	Hitbox->SetCapsuleHalfHeight(GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight() - HitboxHeightInset);
+}
+
+void AGDKCharacter::OnEndCrouch(float HalfHeightAdjust, float ScaledHalfHeightAdjust)
+{
+	Super::OnEndCrouch(HalfHeightAdjust, ScaledHalfHeightAdjust);
+
+	Hitbox->SetCapsuleHalfHeight(GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight() - HitboxHeightInset);
+}
+
 void AGDKCharacter::OnEquippedUpdated_Implementation(AHoldable* Holdable)
 {
 	if (Holdable)
@@ -127,6 +152,7 @@ void AGDKCharacter::StartRagdoll_Implementation()
 
 	Capsule->SetSimulatePhysics(false);
 	Capsule->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Hitbox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	GetCharacterMovement()->StopMovementImmediately();
 	GetCharacterMovement()->DisableMovement();
 
@@ -174,10 +200,15 @@ void AGDKCharacter::DeleteSelf()
 
 float AGDKCharacter::TakeDamage(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	TakeDamageCrossServer(Damage, DamageEvent, EventInstigator, DamageCauser);
+	UDamageSubsystem::DealCrossServerDamage(this, Damage, DamageEvent, EventInstigator, DamageCauser);
 	return Damage;
 }
 
+void AGDKCharacter::SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records)
+{
+	TakeDamageCrossServer(Records);
+}
+
 
 void AGDKCharacter::AttachProtoTeamComponent(FGenericTeamId teamInt)
 {
@@ -197,11 +228,16 @@ void AGDKCharacter::AttachProtoTeamComponent(FGenericTeamId teamInt)
 }
 
 
-void AGDKCharacter::TakeDamageCrossServer_Implementation(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+void AGDKCharacter::TakeDamageCrossServer_Implementation(const TArray<FCrossServerDamageRecord>& Records)
 {
-	float ActualDamage = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
-	HealthComponent->TakeDamage(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
-
+	for (const FCrossServerDamageRecord& Record : Records)
+	{
+		Record.Unpack([this](float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+		{
+			float ActualDamage = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
+			HealthComponent->TakeDamage(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
+		});
+	}
 }
 
 FGenericTeamId AGDKCharacter::GetGenericTeamId() const
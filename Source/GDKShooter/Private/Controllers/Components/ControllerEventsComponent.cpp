@@ -4,13 +4,28 @@
 
 #include "GameFramework/Controller.h"
 #include "GameFramework/PlayerState.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 #include "Runtime/Launch/Resources/Version.h"
+#include "Systems/GDKComponentRegistry.h"
 
 UControllerEventsComponent::UControllerEventsComponent()
 {
 	PrimaryComponentTick.bCanEverTick = false;
 }
 
+void UControllerEventsComponent::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UControllerEventsComponent::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
+}
+
 void UControllerEventsComponent::Death_Implementation(const AController* Killer)
 {
 	DeathEvent.Broadcast(Killer);
@@ -64,3 +79,43 @@ void UControllerEventsComponent::ClientInformOfDeath_Implementation(const FStrin
 {
 	DeathDetailsEvent.Broadcast(KillerName, KillerId);
 }
+
+void UControllerEventsComponent::QueueDamageDealt(const FDamageDealtFeedback& Feedback)
+{
+	if (PendingDamageDealt.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UControllerEventsComponent::FlushDamageDealt);
+	}
+	PendingDamageDealt.Add(Feedback);
+}
+
+void UControllerEventsComponent::FlushDamageDealt()
+{
+	if (PendingDamageDealt.Num() == 0)
+	{
+		return;
+	}
+
+	if (GetOwner()->HasAuthority())
+	{
+		ClientDamageDealt(PendingDamageDealt);
+	}
+	else
+	{
+		DamageDealt(PendingDamageDealt);
+	}
+	PendingDamageDealt.Reset();
+}
+
+void UControllerEventsComponent::DamageDealt_Implementation(const TArray<FDamageDealtFeedback>& Feedback)
+{
+	ClientDamageDealt(Feedback);
+}
+
+void UControllerEventsComponent::ClientDamageDealt_Implementation(const TArray<FDamageDealtFeedback>& Feedback)
+{
+	for (const FDamageDealtFeedback& Entry : Feedback)
+	{
+		DamageDealtEvent.Broadcast(Entry);
+	}
+}
@@ -24,6 +24,19 @@
 #include "Weapons/Weapon.h"
 #include "Interop/SpatialSender.h"
 #include "DrawDebugHelpers.h"
+#include "Systems/GDKComponentRegistry.h"
+#include "GDKStats.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interest Updates Sent"), STAT_InterestUpdatesSent, STATGROUP_GDKShooter);
+
+static TAutoConsoleVariable<int32> CVarRecordInterestPaths(
+	TEXT("GDK.RecordInterestPaths"),
+	0,
+	TEXT("If set, servers write every player's view point to Saved/Interest/Paths.csv twice a second, for the InterestEvaluation commandlet."));
 
 AGDKPlayerController::AGDKPlayerController()
 	: bIgnoreActionInput(false)
@@ -95,14 +108,16 @@ AGDKPlayerController::AGDKPlayerController()
 		
 	////
 
-	//[2] - Setup 1. FOV Constraint query - 100m at top frequency
+	//[2] - Setup 1. FOV Constraint query - view cone out to 60m at top frequency
 	FOVConstraint1 = CreateDefaultSubobject<UAndConstraint>(TEXT("FOVConstraint1"));
 
-	Sphere1 = CreateDefaultSubobject<USphereConstraint>(TEXT("Sphere1"));
-	Sphere1->Radius = 4000;
-	Sphere1->Center = FVector::ZeroVector;
+	ViewConeNear = CreateDefaultSubobject<UViewConeConstraint>(TEXT("ViewConeNear"));
+	ViewConeNear->HalfAngle = 45;
+	ViewConeNear->MinRange = 500;
+	ViewConeNear->MaxRange = 6000;
+	ViewConeNear->NumSpheres = 3;
 
-	FOVConstraint1->Constraints.Add(Sphere1);
+	FOVConstraint1->Constraints.Add(ViewConeNear);
 	FOVConstraint1->Constraints.Add(Actor1);
 
 	query.Constraint = FOVConstraint1;
@@ -113,10 +128,26 @@ AGDKPlayerController::AGDKPlayerController()
 
 	////
 
-	////END
+	//[3] - Setup 2. FOV Constraint query - long sightlines, 60m to 200m at low frequency
+	FOVConstraint2 = CreateDefaultSubobject<UAndConstraint>(TEXT("FOVConstraint2"));
+
+	ViewConeFar = CreateDefaultSubobject<UViewConeConstraint>(TEXT("ViewConeFar"));
+	ViewConeFar->HalfAngle = 30;
+	ViewConeFar->MinRange = 6000;
+	ViewConeFar->MaxRange = 20000;
+	ViewConeFar->NumSpheres = 3;
+
+	FOVConstraint2->Constraints.Add(ViewConeFar);
+	FOVConstraint2->Constraints.Add(Actor1);
+
+	query.Constraint = FOVConstraint2;
+	query.Frequency = 10;
+
+	ActorInterestComponent->Queries.Add(query);
 
-	//Initialize counter for update speed - workaround because we are calling directly in to the net driver without any other management
-	updateCounter = 0;
+	////
+
+	////END
 }
 
 void AGDKPlayerController::Tick(float DeltaTime)
@@ -127,6 +158,16 @@ void AGDKPlayerController::Tick(float DeltaTime)
 	{
 		LatestPawnYaw = GetPawn()->GetActorRotation().Yaw;
 	}
+
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		UpdateInterest(false);
+
+		if (CVarRecordInterestPaths.GetValueOnGameThread() != 0)
+		{
+			RecordInterestPath();
+		}
+	}
 }
 
 void AGDKPlayerController::SetPawn(APawn* InPawn)
@@ -150,57 +191,84 @@ void AGDKPlayerController::SetPawn(APawn* InPawn)
 
 void AGDKPlayerController::QueryTest()
 {
-	FVector vector;
-	FRotator rotator;
-	FVector end;
-
-	GetPlayerViewPoint(vector, rotator);
+	UpdateInterest(true);
+}
 
-	//1. FOV 100
-	end = vector + (rotator.Vector() * 4000.f);
-	//GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Yellow, end.ToString());
+void AGDKPlayerController::UpdateInterest(bool bForce)
+{
+	// Interest is only sent straight through the net driver, there is nothing to update without SpatialOS networking.
+	USpatialNetDriver* SpatialNetDriver = Cast<USpatialNetDriver>(GetWorld()->GetNetDriver());
+	if (SpatialNetDriver == nullptr || SpatialNetDriver->Sender == nullptr)
+	{
+		return;
+	}
 
-	Sphere1->Center = end;
+	const double Now = FPlatformTime::Seconds();
+	if (!bForce && Now - LastInterestUpdateTime < InterestMinInterval)
+	{
+		return;
+	}
 
-	FOVConstraint1->Constraints.Empty();
-	FOVConstraint1->Constraints.Add(Sphere1);
-	FOVConstraint1->Constraints.Add(Actor1);
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
 
-	ActorInterestComponent->Queries[2].Constraint=FOVConstraint1;
-	
-	//End FOV
-	
-	//Update team component - call this seperately not every second
-	AGDKCharacter* charOwned = (AGDKCharacter*)GetPawn();
-	UTeamComponent* tcomp = charOwned->FindComponentByClass<UTeamComponent>();
-	if (tcomp->GetTeam()==0) {
-		//Is red team, get interst on Blue team
-		RelativeSphere->Radius = 15000;
-		PlayerBubbleComponent->ComponentClass = UTagComponent::StaticClass();
-		PlayerBubbleComponent->bIncludeDerivedClasses = true;
-		//GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Blue, charOwned->GetName() + " " + FString::FromInt(tcomp->GetTeam()));
+	//Team 0 is red and gets interest on blue team
+	const UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(GetPawn());
+	const float BubbleRadius = (TeamComponent != nullptr && TeamComponent->GetTeam() == 0) ? 15000.f : 20000.f;
 
+	// Measured from the last sent values rather than the last checked ones, so slow drift still triggers an update eventually.
+	const bool bViewMoved = FVector::DistSquared(ViewLocation, ViewConeNear->Apex) > FMath::Square(InterestMoveThreshold);
+	const bool bViewTurned = FVector::DotProduct(ViewDirection, ViewConeNear->Direction) < FMath::Cos(FMath::DegreesToRadians(InterestAngleThreshold));
+	const bool bTeamChanged = BubbleRadius != RelativeSphere->Radius;
+	if (!bForce && !bViewMoved && !bViewTurned && !bTeamChanged)
+	{
+		return;
 	}
-	else {
-		RelativeSphere->Radius = 20000;
-		PlayerBubbleComponent->ComponentClass = UTagComponent::StaticClass();
-		PlayerBubbleComponent->bIncludeDerivedClasses = true;
-		//GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Red, charOwned->GetName() + " " + FString::FromInt(tcomp->GetTeam()));
-	}
-	
 
-	PlayerBubbleAnd->Constraints.Empty();
-	PlayerBubbleAnd->Constraints.Add(PlayerBubbleComponent);
-	PlayerBubbleAnd->Constraints.Add(Actor1);
-	PlayerBubbleAnd->Constraints.Add(RelativeSphere);
+	// The queries already point at these constraints, only their parameters change.
+	ViewConeNear->Apex = ViewLocation;
+	ViewConeNear->Direction = ViewDirection;
+	ViewConeFar->Apex = ViewLocation;
+	ViewConeFar->Direction = ViewDirection;
+	RelativeSphere->Radius = BubbleRadius;
 
-	ActorInterestComponent->Queries[0].Constraint = PlayerBubbleAnd;
-	
+	LastInterestUpdateTime = Now;
 
-	USpatialNetDriver* driver =(Cast<USpatialNetDriver>(GetWorld()->GetNetDriver()));
-	USpatialSender* sender = driver->Sender;
-	sender->UpdateInterestComponent(this);	
-	
+	INC_DWORD_STAT(STAT_InterestUpdatesSent);
+	SpatialNetDriver->Sender->UpdateInterestComponent(this);
+}
+
+void AGDKPlayerController::GetViewConeConstraints(TArray<const UViewConeConstraint*>& OutConstraints) const
+{
+	OutConstraints.Add(ViewConeNear);
+	OutConstraints.Add(ViewConeFar);
+}
+
+FString AGDKPlayerController::GetInterestPathsFile()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Interest") / TEXT("Paths.csv");
+}
+
+void AGDKPlayerController::RecordInterestPath()
+{
+	// Snapped to half seconds, so samples from every controller line up into frames however their ticks fall.
+	const double SampleTime = FMath::FloorToDouble(GetWorld()->GetTimeSeconds() * 2.0) / 2.0;
+	if (SampleTime <= LastInterestPathTime)
+	{
+		return;
+	}
+	LastInterestPathTime = SampleTime;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	// Time, viewer, location, pitch and yaw.
+	const FString Line = FString::Printf(TEXT("%.1f,%s,%.0f,%.0f,%.0f,%.1f,%.1f\n"),
+		SampleTime, *GetName(), ViewLocation.X, ViewLocation.Y, ViewLocation.Z, ViewRotation.Pitch, ViewRotation.Yaw);
+	FFileHelper::SaveStringToFile(Line, *GetInterestPathsFile(), FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
 }
 
 void AGDKPlayerController::GetPlayerViewPoint(FVector& out_Location, FRotator& out_Rotation) const
@@ -217,18 +285,6 @@ void AGDKPlayerController::GetPlayerViewPoint(FVector& out_Location, FRotator& o
 	}
 }
 
-void AGDKPlayerController::SetControlRotation(const FRotator& NewRotation)
-{
-	Super::SetControlRotation(NewRotation);
-	updateCounter++;
-	if (GetLocalRole() == ROLE_Authority && updateCounter%60==0)
-	{
-		// Networked client in control.
-		QueryTest();
-		updateCounter = 0;
-	}
-}
-
 void AGDKPlayerController::SetUIMode(bool bIsUIMode)
 {
 	bShowMouseCursor = bIsUIMode;
@@ -287,7 +343,7 @@ bool AGDKPlayerController::ServerRequestName_Validate(const FString& NewPlayerNa
 
 void AGDKPlayerController::ServerRequestMetaData_Implementation(const FGDKMetaData NewMetaData)
 {
-	if (UMetaDataComponent* MetaData = Cast<UMetaDataComponent>(PlayerState->GetComponentByClass(UMetaDataComponent::StaticClass())))
+	if (UMetaDataComponent* MetaData = UGDKComponentRegistry::Find<UMetaDataComponent>(PlayerState))
 	{
 		MetaData->SetMetaData(NewMetaData);
 	}
@@ -0,0 +1,141 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Controllers/InterestEvaluationCommandlet.h"
+
+#include "Controllers/GDKPlayerController.h"
+#include "Controllers/ViewConeConstraint.h"
+#include "GDKLogging.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	// The forward sphere the view cones replaced: 40m ahead of the camera with a 40m radius.
+	constexpr float LegacySphereOffset = 4000.0f;
+	constexpr float LegacySphereRadius = 4000.0f;
+
+	struct FViewSample
+	{
+		FString Viewer;
+		FVector Location;
+		FVector Direction;
+	};
+
+	struct FApproachResult
+	{
+		int64 Pulled = 0;
+		int64 Missed = 0;
+		int64 PulledBehind = 0;
+	};
+
+	void LogResult(const TCHAR* Name, const FApproachResult& Result, int64 NumInView)
+	{
+		UE_LOG(LogGDK, Display, TEXT("%-8s pulled %lld, missed %lld of %lld in view (%.1f%%), pulled %lld from behind the viewer"),
+			Name, Result.Pulled, Result.Missed, NumInView, NumInView > 0 ? 100.0 * Result.Missed / NumInView : 0.0, Result.PulledBehind);
+	}
+}
+
+UInterestEvaluationCommandlet::UInterestEvaluationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UInterestEvaluationCommandlet::Main(const FString& Params)
+{
+	FString PathsFile = AGDKPlayerController::GetInterestPathsFile();
+	FParse::Value(*Params, TEXT("Paths="), PathsFile);
+
+	const AGDKPlayerController* Controller = GetDefault<AGDKPlayerController>();
+	FString ControllerClassPath;
+	if (FParse::Value(*Params, TEXT("Controller="), ControllerClassPath))
+	{
+		UClass* ControllerClass = LoadClass<AGDKPlayerController>(nullptr, *ControllerClassPath);
+		if (ControllerClass == nullptr)
+		{
+			UE_LOG(LogGDK, Error, TEXT("Could not load controller class %s"), *ControllerClassPath);
+			return 1;
+		}
+		Controller = ControllerClass->GetDefaultObject<AGDKPlayerController>();
+	}
+
+	TArray<const UViewConeConstraint*> ViewCones;
+	Controller->GetViewConeConstraints(ViewCones);
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *PathsFile))
+	{
+		UE_LOG(LogGDK, Error, TEXT("Could not read recorded paths from %s, record some with GDK.RecordInterestPaths 1"), *PathsFile);
+		return 1;
+	}
+
+	// Samples recorded at the same time form one frame.
+	TMap<FString, TArray<FViewSample>> Frames;
+	for (const FString& Line : Lines)
+	{
+		TArray<FString> Fields;
+		if (Line.ParseIntoArray(Fields, TEXT(","), true) != 7)
+		{
+			continue;
+		}
+
+		FViewSample& Sample = Frames.FindOrAdd(Fields[0]).AddDefaulted_GetRef();
+		Sample.Viewer = Fields[1];
+		Sample.Location = FVector(FCString::Atof(*Fields[2]), FCString::Atof(*Fields[3]), FCString::Atof(*Fields[4]));
+		Sample.Direction = FRotator(FCString::Atof(*Fields[5]), FCString::Atof(*Fields[6]), 0.0f).Vector();
+	}
+
+	int64 NumPairs = 0;
+	int64 NumInView = 0;
+	FApproachResult Sphere;
+	FApproachResult Cone;
+	TArray<FSphere> ConeSpheres;
+
+	for (const TPair<FString, TArray<FViewSample>>& Frame : Frames)
+	{
+		for (const FViewSample& Viewer : Frame.Value)
+		{
+			ConeSpheres.Reset();
+			for (const UViewConeConstraint* ViewCone : ViewCones)
+			{
+				ViewCone->GetCoveringSpheres(Viewer.Location, Viewer.Direction, ConeSpheres);
+			}
+			const FVector LegacyCenter = Viewer.Location + Viewer.Direction * LegacySphereOffset;
+
+			for (const FViewSample& Other : Frame.Value)
+			{
+				if (Other.Viewer == Viewer.Viewer)
+				{
+					continue;
+				}
+				NumPairs++;
+
+				const bool bInView = ViewCones.ContainsByPredicate([&Viewer, &Other](const UViewConeConstraint* ViewCone)
+				{
+					return ViewCone->IsInCone(Viewer.Location, Viewer.Direction, Other.Location);
+				});
+				const bool bBehind = FVector::DotProduct(Other.Location - Viewer.Location, Viewer.Direction) < 0.0f;
+				const bool bPulledBySphere = FVector::DistSquared(Other.Location, LegacyCenter) <= FMath::Square(LegacySphereRadius);
+				const bool bPulledByCone = ConeSpheres.ContainsByPredicate([&Other](const FSphere& ConeSphere)
+				{
+					return ConeSphere.IsInside(Other.Location);
+				});
+
+				NumInView += bInView;
+				Sphere.Pulled += bPulledBySphere;
+				Sphere.Missed += bInView && !bPulledBySphere;
+				Sphere.PulledBehind += bBehind && bPulledBySphere;
+				Cone.Pulled += bPulledByCone;
+				Cone.Missed += bInView && !bPulledByCone;
+				Cone.PulledBehind += bBehind && bPulledByCone;
+			}
+		}
+	}
+
+	UE_LOG(LogGDK, Display, TEXT("Evaluated %d frames, %lld viewer and entity pairs, %lld in a view cone"), Frames.Num(), NumPairs, NumInView);
+	LogResult(TEXT("Sphere"), Sphere, NumInView);
+	LogResult(TEXT("Cone"), Cone, NumInView);
+
+	return 0;
+}
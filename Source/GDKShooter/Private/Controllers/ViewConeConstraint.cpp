@@ -0,0 +1,68 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Controllers/ViewConeConstraint.h"
+
+#include "Schema/Interest.h"
+#include "Schema/StandardLibrary.h"
+
+void UViewConeConstraint::CreateConstraint(const USchemaDatabase& SchemaDatabase, SpatialGDK::QueryConstraint& OutConstraint) const
+{
+	const float CentimetersToMeters = 0.01f;
+
+	TArray<FSphere> Spheres;
+	GetCoveringSpheres(Apex, Direction, Spheres);
+
+	for (const FSphere& Sphere : Spheres)
+	{
+		SpatialGDK::SphereConstraint SphereConstraint;
+		SphereConstraint.Center = SpatialGDK::Coordinates::FromFVector(Sphere.Center);
+		SphereConstraint.Radius = Sphere.W * CentimetersToMeters;
+
+		SpatialGDK::QueryConstraint NewConstraint;
+		NewConstraint.SphereConstraint = SphereConstraint;
+		OutConstraint.OrConstraint.Add(NewConstraint);
+	}
+}
+
+void UViewConeConstraint::GetCoveringSpheres(const FVector& InApex, const FVector& InDirection, TArray<FSphere>& OutSpheres) const
+{
+	const FVector Axis = InDirection.GetSafeNormal();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngle, 1.0f, 80.0f)));
+	const int32 Count = FMath::Max(NumSpheres, 1);
+
+	// The cone widens with range, so geometrically growing segments leave each sphere a similar amount of slack.
+	const float Start = FMath::Max(MinRange, 100.0f);
+	const float Ratio = FMath::Pow(FMath::Max(MaxRange, Start + 1.0f) / Start, 1.0f / Count);
+
+	float Near = Start;
+	for (int32 i = 0; i < Count; i++)
+	{
+		const float Far = Near * Ratio;
+
+		// The segment's farthest points from any center on the axis are on its near or far rim. The smallest enclosing sphere
+		// sits under the far rim when that also reaches the near one, and otherwise balances the two.
+		// Past 45 degrees that sphere would reach behind the apex, so its center moves out until it only touches the apex.
+		const float Center = FMath::Max(FMath::Min(Far * CosHalfAngle, (Far + Near) / (2.0f * CosHalfAngle)), Far / (2.0f * CosHalfAngle));
+		auto RimDistanceSquared = [Center, CosHalfAngle](float Range)
+		{
+			return FMath::Square(Range) + FMath::Square(Center) - 2.0f * Range * Center * CosHalfAngle;
+		};
+
+		const float Radius = FMath::Sqrt(FMath::Max(RimDistanceSquared(Near), RimDistanceSquared(Far)));
+		OutSpheres.Add(FSphere(InApex + Axis * Center, Radius));
+
+		Near = Far;
+	}
+}
+
+bool UViewConeConstraint::IsInCone(const FVector& InApex, const FVector& InDirection, const FVector& Point) const
+{
+	const FVector ToPoint = Point - InApex;
+	const float Range = ToPoint.Size();
+	if (Range < MinRange || Range > MaxRange)
+	{
+		return false;
+	}
+
+	return FVector::DotProduct(ToPoint, InDirection.GetSafeNormal()) >= Range * FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+}
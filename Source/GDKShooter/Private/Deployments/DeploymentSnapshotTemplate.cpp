@@ -2,11 +2,18 @@
 
 #include "Deployments/DeploymentSnapshotTemplate.h"
 
+#include "BuildableSnapshot.h"
+#include "GDKLogging.h"
 #include "SpatialCommonTypes.h"
 #include "SpatialConstants.h"
 #include "Schema/StandardLibrary.h"
 
 bool UDeploymentSnapshotTemplate::WriteToSnapshotOutput(Worker_SnapshotOutputStream* OutputStream, Worker_EntityId& NextEntityId)
+{
+	return WriteSessionEntity(OutputStream, NextEntityId) && WriteBuildableEntities(OutputStream, NextEntityId);
+}
+
+bool UDeploymentSnapshotTemplate::WriteSessionEntity(Worker_SnapshotOutputStream* OutputStream, Worker_EntityId& NextEntityId)
 {
 	Worker_Entity SessionEntity;
 	SessionEntity.entity_id = NextEntityId;
@@ -55,4 +62,53 @@ bool UDeploymentSnapshotTemplate::WriteToSnapshotOutput(Worker_SnapshotOutputStr
 	return success;
 }
 
+bool UDeploymentSnapshotTemplate::WriteBuildableEntities(Worker_SnapshotOutputStream* OutputStream, Worker_EntityId& NextEntityId)
+{
+	FBuildableSnapshot Snapshot;
+	if (!bWriteSavedBuildables || !Snapshot.LoadFromFile())
+	{
+		return true;
+	}
+
+	TArray<FBuildableSnapshot> Chunks;
+	Snapshot.SplitIntoChunks(Chunks);
+
+	// Only servers read the chunks, and only at startup, so no worker needs write access to them.
+	WriteAclMap ComponentWriteAcl;
+	ComponentWriteAcl.Add(SpatialConstants::POSITION_COMPONENT_ID, SpatialConstants::UnrealServerPermission);
+	ComponentWriteAcl.Add(SpatialConstants::METADATA_COMPONENT_ID, SpatialConstants::UnrealServerPermission);
+	ComponentWriteAcl.Add(SpatialConstants::PERSISTENCE_COMPONENT_ID, SpatialConstants::UnrealServerPermission);
+	ComponentWriteAcl.Add(SpatialConstants::ENTITY_ACL_COMPONENT_ID, SpatialConstants::UnrealServerPermission);
+	ComponentWriteAcl.Add(FBuildableSnapshot::ChunkComponentId, SpatialConstants::UnrealServerPermission);
+
+	for (const FBuildableSnapshot& Chunk : Chunks)
+	{
+		Worker_Entity ChunkEntity;
+		ChunkEntity.entity_id = NextEntityId;
+
+		Worker_ComponentData ChunkComponentData{};
+		ChunkComponentData.component_id = FBuildableSnapshot::ChunkComponentId;
+		ChunkComponentData.schema_type = Schema_CreateComponentData();
+		Chunk.WriteChunkComponent(Schema_GetComponentDataFields(ChunkComponentData.schema_type));
+
+		TArray<Worker_ComponentData> Components;
+		Components.Add(SpatialGDK::Position(SpatialGDK::DeploymentOrigin).CreatePositionData());
+		Components.Add(SpatialGDK::Metadata(TEXT("BuildableChunk")).CreateMetadataData());
+		Components.Add(SpatialGDK::Persistence().CreatePersistenceData());
+		Components.Add(SpatialGDK::EntityAcl(SpatialConstants::UnrealServerPermission, ComponentWriteAcl).CreateEntityAclData());
+		Components.Add(ChunkComponentData);
 
+		ChunkEntity.component_count = Components.Num();
+		ChunkEntity.components = Components.GetData();
+
+		Worker_SnapshotOutputStream_WriteEntity(OutputStream, &ChunkEntity);
+		if (Worker_SnapshotOutputStream_GetState(OutputStream).stream_state != WORKER_STREAM_STATE_GOOD)
+		{
+			return false;
+		}
+		NextEntityId++;
+	}
+
+	UE_LOG(LogGDK, Log, TEXT("Wrote %d saved buildables to %d snapshot entities"), Snapshot.Records.Num(), Chunks.Num());
+	return true;
+}
@@ -9,6 +9,7 @@
 #include "GameFramework/GameModeBase.h"
 #include "GameFramework/GameStateBase.h"
 #include "GDKLogging.h"
+#include "Systems/GDKComponentRegistry.h"
 
 UDeathmatchSpawnerComponent::UDeathmatchSpawnerComponent()
 {
@@ -23,7 +24,7 @@ void UDeathmatchSpawnerComponent::RequestSpawn(APlayerController* Controller)
 
 	if (Controller->PlayerState)
 	{
-		if (UPlayerPublisher* PlayerPublisher = Cast<UPlayerPublisher>(GetWorld()->GetGameState()->GetComponentByClass(UPlayerPublisher::StaticClass())))
+		if (UPlayerPublisher* PlayerPublisher = UGDKComponentRegistry::Find<UPlayerPublisher>(GetWorld()->GetGameState()))
 		{
 			PlayerPublisher->PublishPlayer(Controller->PlayerState, EPlayerProgress::InGame);
 		}
@@ -73,9 +74,9 @@ void UDeathmatchSpawnerComponent::SpawnCharacter(APlayerController* Controller)
 
 		Controller->Possess(NewPawn);
 
-		if (UMetaDataComponent* StateMetaData = Cast<UMetaDataComponent>(Controller->PlayerState->GetComponentByClass(UMetaDataComponent::StaticClass())))
+		if (UMetaDataComponent* StateMetaData = UGDKComponentRegistry::Find<UMetaDataComponent>(Controller->PlayerState))
 		{
-			if (UMetaDataComponent* MetaData = Cast<UMetaDataComponent>(NewPawn->GetComponentByClass(UMetaDataComponent::StaticClass())))
+			if (UMetaDataComponent* MetaData = UGDKComponentRegistry::Find<UMetaDataComponent>(NewPawn))
 			{
 				MetaData->SetMetaData(StateMetaData->GetMetaData());
 			}
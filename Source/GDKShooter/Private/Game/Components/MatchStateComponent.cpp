@@ -3,6 +3,8 @@
 #include "Game/Components/MatchStateComponent.h"
 #include "Net/UnrealNetwork.h"
 #include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "Systems/ProjectilePoolSubsystem.h"
 
 UMatchStateComponent::UMatchStateComponent()
 {
@@ -26,4 +28,12 @@ void UMatchStateComponent::SetMatchState(EMatchState NewState)
 
 	CurrentState = NewState;
 	OnRep_State();
+
+	if (CurrentState == EMatchState::InGame)
+	{
+		if (UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>())
+		{
+			Pool->WarmPools();
+		}
+	}
 }
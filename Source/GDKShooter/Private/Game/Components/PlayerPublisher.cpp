@@ -0,0 +1,17 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Game/Components/PlayerPublisher.h"
+
+#include "Systems/GDKComponentRegistry.h"
+
+void UPlayerPublisher::OnRegister()
+{
+	Super::OnRegister();
+	UGDKComponentRegistry::Register(this);
+}
+
+void UPlayerPublisher::OnUnregister()
+{
+	UGDKComponentRegistry::Unregister(this);
+	Super::OnUnregister();
+}
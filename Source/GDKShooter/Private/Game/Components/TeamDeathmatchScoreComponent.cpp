@@ -6,6 +6,7 @@
 #include "Runtime/Launch/Resources/Version.h"
 
 #include "Characters/Components/TeamComponent.h"
+#include "Systems/GDKComponentRegistry.h"
 
 UTeamDeathmatchScoreComponent::UTeamDeathmatchScoreComponent()
 {
@@ -39,7 +40,7 @@ void UTeamDeathmatchScoreComponent::RecordNewPlayer(APlayerState* PlayerState)
 
 	if (!PlayerScoreMap.Contains(NewPlayerId))
 	{
-		if (const UTeamComponent* TeamComponent = PlayerState->FindComponentByClass<UTeamComponent>())
+		if (const UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(PlayerState))
 		{
 			FPlayerScore NewPlayerScore;
 			NewPlayerScore.PlayerId = NewPlayerId;
@@ -86,7 +87,7 @@ void UTeamDeathmatchScoreComponent::RemovePlayer(APlayerState* PlayerState)
 
 	if (PlayerScoreMap.Contains(RemovedPlayerId))
 	{
-		if (const UTeamComponent* TeamComponent = PlayerState->FindComponentByClass<UTeamComponent>())
+		if (const UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(PlayerState))
 		{
 			const uint8 TeamId = TeamComponent->GetTeam().GetId();
 			if (TeamScoreMap.Contains(TeamId))
@@ -117,14 +118,14 @@ void UTeamDeathmatchScoreComponent::RecordKill(APlayerState* KillerState, APlaye
 
 	if (PlayerScoreMap.Contains(KillerId))
 	{
-		const uint8 KillerTeamId = KillerState->FindComponentByClass<UTeamComponent>()->GetTeam().GetId();
+		const uint8 KillerTeamId = UGDKComponentRegistry::Find<UTeamComponent>(KillerState)->GetTeam().GetId();
 
 		++TeamScoreArray[TeamScoreMap[KillerTeamId]].PlayerScores[PlayerScoreMap[KillerId]].Kills;
 	}
 
 	if (PlayerScoreMap.Contains(VictimId))
 	{
-		const uint8 VictimTeamId = VictimState->FindComponentByClass<UTeamComponent>()->GetTeam().GetId();
+		const uint8 VictimTeamId = UGDKComponentRegistry::Find<UTeamComponent>(VictimState)->GetTeam().GetId();
 
 		++TeamScoreArray[TeamScoreMap[VictimTeamId]].PlayerScores[PlayerScoreMap[VictimId]].Deaths;
 	}
@@ -16,6 +16,7 @@
 #include "Math/NumericLimits.h"
 #include "Math/UnrealMathUtility.h"
 #include "Characters/GDKCharacter.h"
+#include "Systems/GDKComponentRegistry.h"
 
 DEFINE_LOG_CATEGORY(LogTeamDeathmatchSpawnerComponent)
 
@@ -39,7 +40,7 @@ void UTeamDeathmatchSpawnerComponent::SetTeams(TArray<FGenericTeamId> TeamIds)
 		APlayerStart* PlayerStart = *It;
 		if (bUseTeamPlayerStarts)
 		{
-			if (UTeamComponent* TeamComponent = PlayerStart->FindComponentByClass<UTeamComponent>())
+			if (UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(PlayerStart))
 			{
 				TeamPlayerStarts.Add(PlayerStart);
 			}
@@ -113,13 +114,13 @@ void UTeamDeathmatchSpawnerComponent::RequestSpawn(APlayerController* Controller
 			return;
 		}
 
-		if (UMetaDataComponent* MetaDataComponent = Cast<UMetaDataComponent>(NewPawn->GetComponentByClass(UMetaDataComponent::StaticClass())))
+		if (UMetaDataComponent* MetaDataComponent = UGDKComponentRegistry::Find<UMetaDataComponent>(NewPawn))
 		{
 			FGDKMetaData MetaData;
 			MetaData.Customization = TeamId;
 			MetaDataComponent->SetMetaData(MetaData);
 		}
-		if (UTeamComponent* TeamComponent = Cast<UTeamComponent>(NewPawn->GetComponentByClass(UTeamComponent::StaticClass())))
+		if (UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(NewPawn))
 		{
 			TeamComponent->SetTeam(FGenericTeamId(TeamId));
 
@@ -134,7 +135,7 @@ void UTeamDeathmatchSpawnerComponent::RequestSpawn(APlayerController* Controller
 
 		if (Controller->PlayerState != nullptr)
 		{
-			if (UTeamComponent* TeamComponent = Cast<UTeamComponent>(Controller->PlayerState->GetComponentByClass(UTeamComponent::StaticClass())))
+			if (UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(Controller->PlayerState))
 			{
 				TeamComponent->SetTeam(FGenericTeamId(TeamId));
 
@@ -147,7 +148,7 @@ void UTeamDeathmatchSpawnerComponent::RequestSpawn(APlayerController* Controller
 				UE_LOG(LogTeamDeathmatchSpawnerComponent, Error, TEXT("TeamComponent Required on PlayerState"));
 			}
 
-			if (UPlayerPublisher* PlayerPublisher = Cast<UPlayerPublisher>(GetWorld()->GetGameState()->GetComponentByClass(UPlayerPublisher::StaticClass())))
+			if (UPlayerPublisher* PlayerPublisher = UGDKComponentRegistry::Find<UPlayerPublisher>(GetWorld()->GetGameState()))
 			{
 				PlayerPublisher->PublishPlayer(Controller->PlayerState, EPlayerProgress::InGame);
 			}
@@ -186,7 +187,7 @@ APlayerStart* UTeamDeathmatchSpawnerComponent::GetNextTeamPlayerStart(FGenericTe
 	for (int i = 0; i < TeamPlayerStarts.Num(); i++)
 	{
 		int index = (i + NextTeamPlayerStart.FindOrAdd(Team, 0)) % TeamPlayerStarts.Num();
-		if (const UTeamComponent* TeamComponent = TeamPlayerStarts[index]->FindComponentByClass<UTeamComponent>())
+		if (const UTeamComponent* TeamComponent = UGDKComponentRegistry::Find<UTeamComponent>(TeamPlayerStarts[index]))
 		{
 			if (TeamComponent->GetTeam() == Team)
 			{
@@ -2,14 +2,27 @@
 
 #include "GameFramework/CrossServerPawn.h"
 
+#include "Systems/DamageSubsystem.h"
+
 float ACrossServerPawn::TakeDamage(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	TakeDamageCrossServer(Damage, DamageEvent, nullptr, DamageCauser);
+	UDamageSubsystem::DealCrossServerDamage(this, Damage, DamageEvent, nullptr, DamageCauser);
 	return Damage;
 }
 
-void ACrossServerPawn::TakeDamageCrossServer_Implementation(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+void ACrossServerPawn::SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records)
+{
+	TakeDamageCrossServer(Records);
+}
+
+void ACrossServerPawn::TakeDamageCrossServer_Implementation(const TArray<FCrossServerDamageRecord>& Records)
 {
-	float ActualDamage = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
-	IncomingDamage.Broadcast(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
+	for (const FCrossServerDamageRecord& Record : Records)
+	{
+		Record.Unpack([this](float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+		{
+			float ActualDamage = Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
+			IncomingDamage.Broadcast(ActualDamage, DamageEvent, EventInstigator, DamageCauser);
+		});
+	}
 }
@@ -3,244 +3,8 @@
 
 #include "MyInstantWeapon.h"
 
-#include "Engine/World.h"
-#include "Kismet/GameplayStatics.h"
-#include "GameFramework/DamageType.h"
-#include "GDKLogging.h"
-#include "Net/UnrealNetwork.h"
-
 
 AMyInstantWeapon::AMyInstantWeapon()
 {
-	BurstInterval = 0.5f;
-	BurstCount = 1;
-	ShotInterval = 0.2f;
-	NextBurstTime = 0.0f;
-	BurstShotsRemaining = 0;
-	ShotBaseDamage = 10.0f;
-	HitValidationTolerance = 50.0f;
-	DamageTypeClass = UDamageType::StaticClass();  // generic damage type
-	ShotVisualizationDelayTolerance = FTimespan::FromMilliseconds(3000.0f);
-}
-
-void AMyInstantWeapon::StartPrimaryUse_Implementation()
-{
-	if (IsBurstFire())
-	{
-		if (!IsPrimaryUsing && NextBurstTime < UGameplayStatics::GetRealTimeSeconds(GetWorld()))
-		{
-			BurstShotsRemaining = BurstCount;
-			NextBurstTime = UGameplayStatics::GetRealTimeSeconds(GetWorld()) + BurstInterval;
-		}
-	}
-
-	Super::StartPrimaryUse_Implementation();
-}
-
-void AMyInstantWeapon::StopPrimaryUse_Implementation()
-{
-	// Can't force stop a burst.
-	if (!IsBurstFire() || bAllowContinuousBurstFire)
-	{
-		Super::StopPrimaryUse_Implementation();
-	}
-}
-
-void AMyInstantWeapon::DoFire_Implementation()
-{
-	if (!bIsActive)
-	{
-		IsPrimaryUsing = false;
-		ConsumeBufferedShot();
-		return;
-	}
-
-	NextShotTime = UGameplayStatics::GetRealTimeSeconds(GetWorld()) + ShotInterval;
-
-	FInstantHitInfo HitInfo = DoLineTrace();
-	if (HitInfo.bDidHit)
-	{
-		ServerDidHit(HitInfo);
-		SpawnFX(HitInfo, true);  // Spawn the hit fx locally
-		AnnounceShot(HitInfo.HitActor ? HitInfo.HitActor->CanBeDamaged() : false);
-	}
-	else
-	{
-		ServerDidMiss(HitInfo);
-		SpawnFX(HitInfo, false);  // Spawn the hit fx locally
-		AnnounceShot(false);
-	}
-
-	if (IsBurstFire())
-	{
-		--BurstShotsRemaining;
-		if (BurstShotsRemaining <= 0)
-		{
-			FinishedBurst();
-			if (bAllowContinuousBurstFire)
-			{
-				BurstShotsRemaining = BurstCount;
-				// We will force a cooldown for the full burst interval, regardless of the time already consumed in the previous burst, for simplicity.
-				ForceCooldown(BurstInterval);
-			}
-			else
-			{
-				if (GetMovementComponent())
-				{
-					GetMovementComponent()->SetIsBusy(false);
-				}
-				IsPrimaryUsing = false;
-			}
-		}
-	}
-
-}
-
-FVector AMyInstantWeapon::GetLineTraceDirection()
-{
-	FVector Direction = Super::GetLineTraceDirection();
-
-	float SpreadToUse = SpreadAt100m;
-	if (GetMovementComponent())
-	{
-		if (GetMovementComponent()->IsAiming())
-		{
-			SpreadToUse = SpreadAt100mWhenAiming;
-		}
-		if (GetMovementComponent()->IsCrouching())
-		{
-			SpreadToUse *= SpreadCrouchModifier;
-		}
-	}
-
-	if (SpreadToUse > 0)
-	{
-		auto Spread = FMath::RandPointInCircle(SpreadToUse);
-		Direction = Direction.Rotation().RotateVector(FVector(10000, Spread.X, Spread.Y));
-	}
-
-	return Direction;
-}
-
-void AMyInstantWeapon::NotifyClientsOfHit(const FInstantHitInfo& HitInfo, bool bImpact)
-{
-	check(GetNetMode() < NM_Client);
-
-	MulticastNotifyHit(HitInfo, bImpact);
-}
-
-void AMyInstantWeapon::SpawnFX(const FInstantHitInfo& HitInfo, bool bImpact)
-{
-	if (GetNetMode() < NM_Client)
-	{
-		return;
-	}
-
-	AMyInstantWeapon::OnRenderShot(HitInfo.Location, bImpact);
-}
-
-bool AMyInstantWeapon::ValidateHit(const FInstantHitInfo& HitInfo)
-{
-	check(GetNetMode() < NM_Client);
-
-	if (HitInfo.HitActor == nullptr)
-	{
-		return false;
-	}
-
-	// Get the bounding box of the actor we hit.
-	const FBox HitBox = HitInfo.HitActor->GetComponentsBoundingBox();
-
-	// Calculate the extent of the box along all 3 axes an add a tolerance factor.
-	FVector BoxExtent = 0.5 * (HitBox.Max - HitBox.Min) + (HitValidationTolerance * FVector::OneVector);
-	FVector BoxCenter = (HitBox.Max + HitBox.Min) * 0.5;
-
-	// Avoid precision errors for really thin objects.
-	BoxExtent.X = FMath::Max(20.0f, BoxExtent.X);
-	BoxExtent.Y = FMath::Max(20.0f, BoxExtent.Y);
-	BoxExtent.Z = FMath::Max(20.0f, BoxExtent.Z);
-
-	// Check whether the hit is within the box + tolerance.
-	if (FMath::Abs(HitInfo.Location.X - BoxCenter.X) > BoxExtent.X ||
-		FMath::Abs(HitInfo.Location.Y - BoxCenter.Y) > BoxExtent.Y ||
-		FMath::Abs(HitInfo.Location.Z - BoxCenter.Z) > BoxExtent.Z)
-	{
-		return false;
-	}
-
-	return true;
-}
-
-void AMyInstantWeapon::DealDamage(const FInstantHitInfo& HitInfo)
-{
-	GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, TEXT("DealDamage - MyInstantWeapon.cpp"));
-
-	GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, HitInfo.HitActor->GetClass()->GetFName().ToString());
-	if (HitInfo.HitActor->IsA(ABuildable::StaticClass())) {
-		Cast<ABuildable>(HitInfo.HitActor)->Build(25.f);
-		GEngine->AddOnScreenDebugMessage(-1, 15, FColor::Green, TEXT("DealDamage + HIT - MyInstantWeapon.cpp"));
-	}
+	DamagePolicy = &FBuildRepairDamagePolicy::Apply;
 }
-
-bool AMyInstantWeapon::ServerDidHit_Validate(const FInstantHitInfo& HitInfo)
-{
-	return true;
-}
-
-void AMyInstantWeapon::ServerDidHit_Implementation(const FInstantHitInfo& HitInfo)
-{
-
-	bool bDoNotifyHit = false;
-
-	if (HitInfo.HitActor == nullptr)
-	{
-		bDoNotifyHit = true;
-	}
-	else
-	{
-		if (ValidateHit(HitInfo))
-		{
-			DealDamage(HitInfo);
-			bDoNotifyHit = true;
-		}
-		else
-		{
-			UE_LOG(LogGDK, Verbose, TEXT("%s server: rejected hit of actor %s"), *this->GetName(), *HitInfo.HitActor->GetName());
-		}
-	}
-
-	if (bDoNotifyHit)
-	{
-		NotifyClientsOfHit(HitInfo, true);
-	}
-}
-
-bool AMyInstantWeapon::ServerDidMiss_Validate(const FInstantHitInfo& HitInfo)
-{
-	return true;
-}
-
-void AMyInstantWeapon::ServerDidMiss_Implementation(const FInstantHitInfo& HitInfo)
-{
-	NotifyClientsOfHit(HitInfo, false);
-}
-
-void AMyInstantWeapon::MulticastNotifyHit_Implementation(FInstantHitInfo HitInfo, bool bImpact)
-{
-	// Make sure we're a client, and we're not the client that owns this gun (they will have already played the effect locally).
-	APawn* Pawn = Cast<APawn>(GetOwner());
-
-	if (GetNetMode() != NM_DedicatedServer &&
-		(Pawn == nullptr || !Pawn->IsLocallyControlled()))
-	{
-		SpawnFX(HitInfo, bImpact);
-	}
-}
-
-void AMyInstantWeapon::SetIsActive(bool bNewActive)
-{
-	Super::SetIsActive(bNewActive);
-
-	ConsumeBufferedShot();
-}
-
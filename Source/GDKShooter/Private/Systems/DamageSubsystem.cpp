@@ -0,0 +1,170 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/DamageSubsystem.h"
+
+#include "Characters/Components/HealthComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GDKStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("DamageSubsystem Resolve"), STAT_DamageSubsystemResolve, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Records"), STAT_DamageRecords, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Victims"), STAT_DamageVictims, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("CrossServer Damage Records"), STAT_CrossServerDamageRecords, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("CrossServer Damage RPCs"), STAT_CrossServerDamageRPCs, STATGROUP_GDKShooter);
+
+void UDamageSubsystem::Deinitialize()
+{
+	PendingRecords.Empty();
+	ResolvingRecords.Empty();
+	PendingCrossServerDamage.Empty();
+	PendingCrossServerIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UDamageSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && (PendingRecords.Num() > 0 || PendingCrossServerDamage.Num() > 0);
+}
+
+TStatId UDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UDamageSubsystem::QueueDamage(FDamageRecord&& Record)
+{
+	Record.Sequence = NextSequence++;
+	PendingRecords.Add(MoveTemp(Record));
+}
+
+void UDamageSubsystem::DealCrossServerDamage(AActor* Victim, float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	const FCrossServerDamageRecord Record = FCrossServerDamageRecord::Make(Damage, DamageEvent, EventInstigator, DamageCauser);
+
+	UWorld* World = Victim->GetWorld();
+	if (UDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UDamageSubsystem>() : nullptr)
+	{
+		DamageSubsystem->QueueCrossServerDamage(Victim, Record);
+	}
+	else if (ICrossServerDamageReceiver* Receiver = Cast<ICrossServerDamageReceiver>(Victim))
+	{
+		Receiver->SendCrossServerDamage({ Record });
+	}
+}
+
+void UDamageSubsystem::QueueCrossServerDamage(AActor* Victim, const FCrossServerDamageRecord& Record)
+{
+	INC_DWORD_STAT(STAT_CrossServerDamageRecords);
+
+	if (const int32* Index = PendingCrossServerIndices.Find(Victim))
+	{
+		PendingCrossServerDamage[*Index].Records.Add(Record);
+		return;
+	}
+
+	PendingCrossServerIndices.Add(Victim, PendingCrossServerDamage.Num());
+	FPendingCrossServerDamage& Pending = PendingCrossServerDamage.AddDefaulted_GetRef();
+	Pending.Victim = Victim;
+	Pending.Records.Add(Record);
+}
+
+void UDamageSubsystem::FlushCrossServerDamage()
+{
+	if (PendingCrossServerDamage.Num() == 0)
+	{
+		return;
+	}
+
+	// RPCs to local victims run immediately and may queue more damage, which goes out next frame.
+	TArray<FPendingCrossServerDamage> Sending = MoveTemp(PendingCrossServerDamage);
+	PendingCrossServerDamage.Reset();
+	PendingCrossServerIndices.Reset();
+
+	for (const FPendingCrossServerDamage& Pending : Sending)
+	{
+		if (ICrossServerDamageReceiver* Receiver = Cast<ICrossServerDamageReceiver>(Pending.Victim.Get()))
+		{
+			INC_DWORD_STAT(STAT_CrossServerDamageRPCs);
+			Receiver->SendCrossServerDamage(Pending.Records);
+		}
+	}
+}
+
+void UDamageSubsystem::Tick(float DeltaTime)
+{
+	// Cross-server damage to victims this worker owns is queued for resolution, so it resolves in the same frame.
+	FlushCrossServerDamage();
+	ResolvePendingDamage();
+}
+
+void UDamageSubsystem::ResolvePendingDamage()
+{
+	if (PendingRecords.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DamageSubsystemResolve);
+	INC_DWORD_STAT_BY(STAT_DamageRecords, PendingRecords.Num());
+
+	// Damage caused while resolving (e.g. by death events) is queued for the next frame.
+	Swap(PendingRecords, ResolvingRecords);
+	PendingRecords.Reset();
+
+	// Records are already in sequence order, a stable sort groups them per victim without reordering hits.
+	ResolvingRecords.StableSort([](const FDamageRecord& A, const FDamageRecord& B)
+	{
+		return A.Victim.Get() < B.Victim.Get();
+	});
+
+	struct FPendingDeath
+	{
+		uint64 Sequence;
+		TWeakObjectPtr<UHealthComponent> Victim;
+		TWeakObjectPtr<AController> Instigator;
+	};
+	TArray<FPendingDeath, TInlineAllocator<8>> Deaths;
+
+	int32 RunStart = 0;
+	while (RunStart < ResolvingRecords.Num())
+	{
+		UHealthComponent* Victim = ResolvingRecords[RunStart].Victim.Get();
+		int32 RunEnd = RunStart + 1;
+		while (RunEnd < ResolvingRecords.Num() && ResolvingRecords[RunEnd].Victim.Get() == Victim)
+		{
+			RunEnd++;
+		}
+
+		if (Victim != nullptr)
+		{
+			INC_DWORD_STAT(STAT_DamageVictims);
+
+			const TArrayView<const FDamageRecord> VictimRecords(ResolvingRecords.GetData() + RunStart, RunEnd - RunStart);
+			const int32 KillingRecord = Victim->ResolveDamage(VictimRecords);
+			if (KillingRecord != INDEX_NONE)
+			{
+				const FDamageRecord& Killer = VictimRecords[KillingRecord];
+				Deaths.Add(FPendingDeath{ Killer.Sequence, Victim, Killer.Instigator });
+			}
+		}
+
+		RunStart = RunEnd;
+	}
+
+	// Announce deaths in the order the killing hits arrived, as they would have been without buffering.
+	Deaths.Sort([](const FPendingDeath& A, const FPendingDeath& B)
+	{
+		return A.Sequence < B.Sequence;
+	});
+	for (const FPendingDeath& Death : Deaths)
+	{
+		if (UHealthComponent* Victim = Death.Victim.Get())
+		{
+			Victim->HandleDeath(Death.Instigator.Get());
+		}
+	}
+
+	ResolvingRecords.Reset();
+}
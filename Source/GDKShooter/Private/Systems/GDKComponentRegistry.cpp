@@ -0,0 +1,120 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/GDKComponentRegistry.h"
+
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GDKStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Component Registry Lookups"), STAT_ComponentRegistryLookups, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Component Registry Misses"), STAT_ComponentRegistryMisses, STATGROUP_GDKShooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Component Registry Actors"), STAT_ComponentRegistryActors, STATGROUP_GDKShooter);
+
+void UGDKComponentRegistry::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_ComponentRegistryActors, ActorSlots.Num());
+	ActorSlots.Empty();
+
+	Super::Deinitialize();
+}
+
+UGDKComponentRegistry* UGDKComponentRegistry::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGDKComponentRegistry>() : nullptr;
+}
+
+void UGDKComponentRegistry::RegisterSlot(UActorComponent* Component, EGDKComponentSlot Slot)
+{
+	check(IsInGameThread());
+
+	AActor* Owner = Component->GetOwner();
+	UGDKComponentRegistry* Registry = Owner ? Get(Owner) : nullptr;
+	if (Registry == nullptr)
+	{
+		return;
+	}
+
+	FSlots* Slots = Registry->ActorSlots.Find(Owner);
+	if (Slots == nullptr)
+	{
+		Slots = &Registry->ActorSlots.Add(Owner);
+		INC_DWORD_STAT(STAT_ComponentRegistryActors);
+	}
+
+	TWeakObjectPtr<UActorComponent>& Entry = Slots->Components[(int32)Slot];
+	if (!Entry.IsValid())
+	{
+		Entry = Component;
+	}
+}
+
+void UGDKComponentRegistry::UnregisterSlot(UActorComponent* Component, EGDKComponentSlot Slot, UClass* SlotClass)
+{
+	check(IsInGameThread());
+
+	AActor* Owner = Component->GetOwner();
+	UGDKComponentRegistry* Registry = Owner ? Get(Owner) : nullptr;
+	FSlots* Slots = Registry ? Registry->ActorSlots.Find(Owner) : nullptr;
+	if (Slots == nullptr)
+	{
+		return;
+	}
+
+	// Another component of the same type on the actor takes over the slot.
+	TWeakObjectPtr<UActorComponent>& Entry = Slots->Components[(int32)Slot];
+	if (Entry == Component)
+	{
+		Entry = FindRegisteredComponent(Owner, SlotClass, Component);
+	}
+
+	for (const TWeakObjectPtr<UActorComponent>& Remaining : Slots->Components)
+	{
+		if (Remaining.IsValid())
+		{
+			return;
+		}
+	}
+
+	Registry->ActorSlots.Remove(Owner);
+	DEC_DWORD_STAT(STAT_ComponentRegistryActors);
+}
+
+UActorComponent* UGDKComponentRegistry::FindSlot(const AActor* Actor, EGDKComponentSlot Slot, UClass* SlotClass)
+{
+	INC_DWORD_STAT(STAT_ComponentRegistryLookups);
+
+	if (Actor == nullptr)
+	{
+		return nullptr;
+	}
+
+	UGDKComponentRegistry* Registry = Get(Actor);
+	const FSlots* Slots = Registry ? Registry->ActorSlots.Find(Actor) : nullptr;
+	if (UActorComponent* Component = Slots ? Slots->Components[(int32)Slot].Get() : nullptr)
+	{
+		return Component;
+	}
+
+	// Components that registered before the world had its subsystems, or actors outside any world, e.g. default objects.
+	INC_DWORD_STAT(STAT_ComponentRegistryMisses);
+	UActorComponent* Component = FindRegisteredComponent(Actor, SlotClass);
+	if (Component != nullptr && Registry != nullptr)
+	{
+		RegisterSlot(Component, Slot);
+	}
+	return Component;
+}
+
+UActorComponent* UGDKComponentRegistry::FindRegisteredComponent(const AActor* Actor, UClass* SlotClass, const UActorComponent* Excluded)
+{
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component != nullptr && Component != Excluded && Component->IsRegistered() && Component->IsA(SlotClass))
+		{
+			return Component;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/ICrossServerDamageReceiver.h"
+
+#include "GameFramework/Actor.h"
+
+FCrossServerDamageRecord FCrossServerDamageRecord::Make(float InDamage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* InDamageCauser)
+{
+	FCrossServerDamageRecord Record;
+	Record.Damage = InDamage;
+	Record.DamageTypeClass = DamageEvent.DamageTypeClass;
+	Record.Instigator = EventInstigator;
+	Record.DamageCauser = InDamageCauser;
+
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	{
+		const FPointDamageEvent& PointDamageEvent = static_cast<const FPointDamageEvent&>(DamageEvent);
+		Record.Kind = ECrossServerDamageKind::Point;
+		Record.Location = PointDamageEvent.HitInfo.ImpactPoint;
+		Record.ShotDirection = PointDamageEvent.ShotDirection;
+		Record.Item = PointDamageEvent.HitInfo.Item;
+	}
+	else if (DamageEvent.IsOfType(FRadialDamageEvent::ClassID))
+	{
+		const FRadialDamageEvent& RadialDamageEvent = static_cast<const FRadialDamageEvent&>(DamageEvent);
+		Record.Kind = ECrossServerDamageKind::Radial;
+		Record.Location = RadialDamageEvent.Origin;
+
+		// Same falloff as AActor::InternalTakeRadialDamage, using the closest hit component.
+		if (RadialDamageEvent.ComponentHits.Num() > 0)
+		{
+			float ClosestHitDistSq = MAX_flt;
+			for (const FHitResult& Hit : RadialDamageEvent.ComponentHits)
+			{
+				ClosestHitDistSq = FMath::Min(ClosestHitDistSq, (RadialDamageEvent.Origin - Hit.ImpactPoint).SizeSquared());
+			}
+			const float DamageScale = RadialDamageEvent.Params.GetDamageScale(FMath::Sqrt(ClosestHitDistSq));
+			Record.Damage = FMath::Lerp(RadialDamageEvent.Params.MinimumDamage, InDamage, FMath::Max(0.f, DamageScale));
+		}
+		else
+		{
+			// Instanced damageables, see URadialDamageSubsystem::RegisterInstancedDamageable.
+			Record.RadialParams = RadialDamageEvent.Params;
+		}
+	}
+
+	return Record;
+}
+
+void FCrossServerDamageRecord::Unpack(TFunctionRef<void(float, const FDamageEvent&, AController*, AActor*)> Apply) const
+{
+	switch (Kind)
+	{
+	case ECrossServerDamageKind::Point:
+	{
+		FPointDamageEvent PointDamageEvent;
+		PointDamageEvent.DamageTypeClass = DamageTypeClass;
+		PointDamageEvent.Damage = Damage;
+		PointDamageEvent.HitInfo.ImpactPoint = Location;
+		PointDamageEvent.ShotDirection = ShotDirection;
+		PointDamageEvent.HitInfo.Item = Item;
+		Apply(Damage, PointDamageEvent, Instigator, DamageCauser);
+		break;
+	}
+	case ECrossServerDamageKind::Radial:
+	{
+		// Falloff was applied by the sender, so the event carries the final damage at full scale.
+		FRadialDamageEvent RadialDamageEvent;
+		RadialDamageEvent.DamageTypeClass = DamageTypeClass;
+		RadialDamageEvent.Origin = Location;
+		RadialDamageEvent.Params.BaseDamage = Damage;
+		RadialDamageEvent.Params.MinimumDamage = Damage;
+		Apply(Damage, RadialDamageEvent, Instigator, DamageCauser);
+		break;
+	}
+	default:
+	{
+		FDamageEvent GenericDamageEvent(DamageTypeClass);
+		Apply(Damage, GenericDamageEvent, Instigator, DamageCauser);
+		break;
+	}
+	}
+}
@@ -0,0 +1,147 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/ProjectilePoolSubsystem.h"
+
+#include "Engine/World.h"
+#include "GDKLogging.h"
+#include "GDKStats.h"
+#include "Kismet/GameplayStatics.h"
+#include "Weapons/Projectile.h"
+#include "Weapons/Weapon.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Pool Hits"), STAT_ProjectilePoolHits, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Pool Misses"), STAT_ProjectilePoolMisses, STATGROUP_GDKShooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Size"), STAT_ProjectilePoolSize, STATGROUP_GDKShooter);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Projectile Pool Hit Rate"), STAT_ProjectilePoolHitRate, STATGROUP_GDKShooter);
+
+void UProjectilePoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	UpdatePoolStats();
+
+	Super::Deinitialize();
+}
+
+void UProjectilePoolSubsystem::RegisterProjectileClass(TSubclassOf<AProjectile> ProjectileClass, int32 WarmCount)
+{
+	if (!ProjectileClass)
+	{
+		return;
+	}
+
+	FProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	Pool.WarmCount = FMath::Clamp(FMath::Max(Pool.WarmCount, WarmCount), 0, MaxPooledPerClass);
+}
+
+void UProjectilePoolSubsystem::WarmPools()
+{
+	for (auto& Entry : Pools)
+	{
+		FProjectilePool& Pool = Entry.Value;
+		while (Pool.Inactive.Num() < Pool.WarmCount)
+		{
+			AProjectile* Projectile = SpawnPooledProjectile(Entry.Key, FTransform::Identity);
+			if (!Projectile)
+			{
+				break;
+			}
+			Projectile->DeactivateForPool();
+			Pool.Inactive.Add(Projectile);
+		}
+	}
+
+	UpdatePoolStats();
+}
+
+AProjectile* UProjectilePoolSubsystem::AcquireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FTransform& SpawnTransform, AWeapon* InstigatingWeapon, const FGDKMetaData& MetaData)
+{
+	if (!ProjectileClass)
+	{
+		return nullptr;
+	}
+
+	TotalAcquires++;
+
+	AProjectile* Projectile = nullptr;
+	if (FProjectilePool* Pool = Pools.Find(ProjectileClass))
+	{
+		while (Pool->Inactive.Num() > 0 && !Projectile)
+		{
+			AProjectile* Candidate = Pool->Inactive.Pop(false);
+			// Pooled projectiles can be destroyed with the level or handed over to another worker while idle.
+			if (IsValid(Candidate) && Candidate->HasAuthority())
+			{
+				Projectile = Candidate;
+			}
+		}
+	}
+
+	if (Projectile)
+	{
+		TotalPoolHits++;
+		INC_DWORD_STAT(STAT_ProjectilePoolHits);
+
+		Projectile->SetPlayer(InstigatingWeapon);
+		Projectile->MetaData = MetaData;
+		Projectile->ResetForReuse(SpawnTransform);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_ProjectilePoolMisses);
+
+		Projectile = Cast<AProjectile>(UGameplayStatics::BeginDeferredActorSpawnFromClass(this, ProjectileClass, SpawnTransform));
+		if (Projectile)
+		{
+			Projectile->SetPlayer(InstigatingWeapon);
+			Projectile->MetaData = MetaData;
+			UGameplayStatics::FinishSpawningActor(Projectile, SpawnTransform);
+		}
+	}
+
+	UpdatePoolStats();
+	return Projectile;
+}
+
+void UProjectilePoolSubsystem::ReleaseProjectile(AProjectile* Projectile)
+{
+	if (!IsValid(Projectile))
+	{
+		return;
+	}
+
+	FProjectilePool& Pool = Pools.FindOrAdd(Projectile->GetClass());
+	if (Pool.Inactive.Num() >= MaxPooledPerClass || !Projectile->HasAuthority())
+	{
+		Projectile->Destroy();
+		return;
+	}
+
+	Projectile->DeactivateForPool();
+	Pool.Inactive.Add(Projectile);
+	UpdatePoolStats();
+}
+
+AProjectile* UProjectilePoolSubsystem::SpawnPooledProjectile(TSubclassOf<AProjectile> ProjectileClass, const FTransform& SpawnTransform)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AProjectile* Projectile = GetWorld()->SpawnActor<AProjectile>(ProjectileClass, SpawnTransform, SpawnParams);
+	if (!Projectile)
+	{
+		UE_LOG(LogGDK, Warning, TEXT("Failed to warm projectile pool for %s"), *GetNameSafe(ProjectileClass));
+	}
+	return Projectile;
+}
+
+void UProjectilePoolSubsystem::UpdatePoolStats()
+{
+	int32 PoolSize = 0;
+	for (const auto& Entry : Pools)
+	{
+		PoolSize += Entry.Value.Inactive.Num();
+	}
+
+	SET_DWORD_STAT(STAT_ProjectilePoolSize, PoolSize);
+	SET_FLOAT_STAT(STAT_ProjectilePoolHitRate, TotalAcquires > 0 ? float(TotalPoolHits) / float(TotalAcquires) : 0.0f);
+}
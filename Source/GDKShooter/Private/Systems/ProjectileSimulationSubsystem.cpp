@@ -0,0 +1,271 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/ProjectileSimulationSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/DamageType.h"
+#include "GDKStats.h"
+#include "Kismet/GameplayStatics.h"
+#include "Systems/RadialDamageSubsystem.h"
+#include "Weapons/Projectile.h"
+#include "Weapons/ProjectileWeapon.h"
+
+DECLARE_CYCLE_STAT(TEXT("ProjectileSimulation Tick"), STAT_ProjectileSimulationTick, STATGROUP_GDKShooter);
+DECLARE_CYCLE_STAT(TEXT("ProjectileSimulation Sweeps"), STAT_ProjectileSimulationSweeps, STATGROUP_GDKShooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Projectiles"), STAT_SimulatedProjectiles, STATGROUP_GDKShooter);
+
+namespace
+{
+	// Small offset to keep bouncing projectiles off the surface they hit.
+	const float BounceSurfaceOffset = 0.1f;
+}
+
+void UProjectileSimulationSubsystem::Deinitialize()
+{
+	Positions.Empty();
+	Velocities.Empty();
+	Lifetimes.Empty();
+	Bounces.Empty();
+	ArchetypeIds.Empty();
+	Weapons.Empty();
+	IgnoredActors.Empty();
+	InstigatingControllers.Empty();
+	VisualActors.Empty();
+	Authoritative.Empty();
+
+	SET_DWORD_STAT(STAT_SimulatedProjectiles, 0);
+
+	Super::Deinitialize();
+}
+
+bool UProjectileSimulationSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && Positions.Num() > 0;
+}
+
+TStatId UProjectileSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSimulationSubsystem, STATGROUP_Tickables);
+}
+
+uint16 UProjectileSimulationSubsystem::FindOrAddArchetype(TSubclassOf<AProjectile> ProjectileClass)
+{
+	if (const uint16* Existing = ArchetypeIndices.Find(ProjectileClass))
+	{
+		return *Existing;
+	}
+
+	const uint16 Index = Archetypes.Add(GetDefault<AProjectile>(ProjectileClass)->MakeSimulationArchetype());
+	ArchetypeIndices.Add(ProjectileClass, Index);
+	return Index;
+}
+
+void UProjectileSimulationSubsystem::SpawnProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Origin, const FVector& Direction, AProjectileWeapon* Weapon, bool bAuthoritative, TSubclassOf<AActor> VisualClass)
+{
+	if (!ProjectileClass)
+	{
+		return;
+	}
+
+	const uint16 ArchetypeId = FindOrAddArchetype(ProjectileClass);
+	const AProjectile* Defaults = GetDefault<AProjectile>(ProjectileClass);
+
+	AActor* Shooter = Weapon ? Weapon->GetOwner() : nullptr;
+	APawn* ShooterPawn = Cast<APawn>(Shooter);
+
+	Positions.Add(Origin);
+	Velocities.Add(Direction.GetSafeNormal() * Defaults->GetInitialSpeed());
+	Lifetimes.Add(Archetypes[ArchetypeId].LifeTillExplode);
+	Bounces.Add(0);
+	ArchetypeIds.Add(ArchetypeId);
+	Weapons.Add(Weapon);
+	IgnoredActors.Add(Shooter);
+	InstigatingControllers.Add(ShooterPawn ? ShooterPawn->GetController() : nullptr);
+	Authoritative.Add(bAuthoritative);
+
+	AActor* Visual = nullptr;
+	if (VisualClass)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		Visual = GetWorld()->SpawnActor<AActor>(VisualClass, Origin, Direction.Rotation(), SpawnParams);
+	}
+	VisualActors.Add(Visual);
+
+	INC_DWORD_STAT(STAT_SimulatedProjectiles);
+}
+
+void UProjectileSimulationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileSimulationTick);
+
+	UWorld* World = GetWorld();
+	if (!World || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	const float GravityZ = World->GetGravityZ();
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSimulation), true);
+
+	// Iterate backwards so swap-removal of finished projectiles does not skip any.
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileSimulationSweeps);
+	for (int32 Index = Positions.Num() - 1; Index >= 0; Index--)
+	{
+		const FSimulatedProjectileArchetype& Archetype = Archetypes[ArchetypeIds[Index]];
+
+		Lifetimes[Index] -= DeltaTime;
+		if (Lifetimes[Index] <= 0.0f)
+		{
+			Explode(Index, nullptr);
+			continue;
+		}
+
+		FVector& Velocity = Velocities[Index];
+		const FVector Start = Positions[Index];
+
+		// Stopped projectiles stay where they came to rest until their lifetime runs out, as a stopped movement component does.
+		if (Velocity.IsZero())
+		{
+			continue;
+		}
+
+		Velocity.Z += GravityZ * Archetype.GravityScale * DeltaTime;
+		if (Archetype.MaxSpeed > 0.0f)
+		{
+			Velocity = Velocity.GetClampedToMaxSize(Archetype.MaxSpeed);
+		}
+
+		const FVector End = Start + Velocity * DeltaTime;
+
+		QueryParams.ClearIgnoredActors();
+		if (AActor* Ignored = IgnoredActors[Index].Get())
+		{
+			QueryParams.AddIgnoredActor(Ignored);
+		}
+
+		FHitResult Hit;
+		if (!World->SweepSingleByObjectType(Hit, Start, End, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(Archetype.Radius), QueryParams))
+		{
+			Positions[Index] = End;
+			if (AActor* Visual = VisualActors[Index].Get())
+			{
+				Visual->SetActorLocationAndRotation(End, Velocity.Rotation());
+			}
+			continue;
+		}
+
+		Positions[Index] = Hit.Location;
+
+		// Pawns are treated like the actor projectile's pawn overlap, which explodes without point damage.
+		if (Cast<APawn>(Hit.GetActor()))
+		{
+			Explode(Index, nullptr);
+			continue;
+		}
+
+		// Everything else like a movement component impact: without bouncing, the projectile stops on the spot.
+		if (!Archetype.bShouldBounce)
+		{
+			StopProjectile(Index, Hit);
+			continue;
+		}
+
+		const FVector Normal = Hit.ImpactNormal;
+		const float NormalSpeed = FVector::DotProduct(Velocity, Normal);
+		const FVector Tangent = Velocity - NormalSpeed * Normal;
+		Velocity = Tangent * FMath::Clamp(1.0f - Archetype.Friction, 0.0f, 1.0f) - NormalSpeed * Archetype.Bounciness * Normal;
+		Positions[Index] = Hit.Location + Normal * BounceSurfaceOffset;
+
+		Bounces[Index]++;
+		if (Archetype.MaximumBounces >= 0 && Bounces[Index] > Archetype.MaximumBounces)
+		{
+			Explode(Index, nullptr);
+			continue;
+		}
+
+		if (Velocity.SizeSquared() < FMath::Square(Archetype.BounceVelocityStopThreshold))
+		{
+			StopProjectile(Index, Hit);
+		}
+	}
+}
+
+void UProjectileSimulationSubsystem::StopProjectile(int32 Index, const FHitResult& StopHit)
+{
+	if (Archetypes[ArchetypeIds[Index]].bExplodeOnStop)
+	{
+		Explode(Index, &StopHit);
+	}
+	else
+	{
+		// Resting projectiles wait for their lifetime to run out, as the actor projectile does.
+		Velocities[Index] = FVector::ZeroVector;
+	}
+}
+
+void UProjectileSimulationSubsystem::Explode(int32 Index, const FHitResult* StopHit)
+{
+	const FSimulatedProjectileArchetype& Archetype = Archetypes[ArchetypeIds[Index]];
+	const FVector Location = Positions[Index];
+	AProjectileWeapon* Weapon = Weapons[Index].Get();
+
+	if (Authoritative[Index])
+	{
+		AController* InstigatingController = InstigatingControllers[Index].Get();
+
+		if (StopHit && StopHit->GetActor())
+		{
+			// The weapon stands in for AProjectile's DamageCauser, so victims see damage coming from the shooter rather than the
+			// projectile's last position, and the direction of travel is kept in ShotDirection.
+			FPointDamageEvent DmgEvent;
+			DmgEvent.DamageTypeClass = Archetype.DamageTypeClass;
+			DmgEvent.ShotDirection = (StopHit->TraceEnd - StopHit->TraceStart).GetSafeNormal();
+			DmgEvent.HitInfo.ImpactPoint = StopHit->Location;
+			DmgEvent.HitInfo.Component = StopHit->Component;
+			DmgEvent.HitInfo.Item = StopHit->Item;
+
+			StopHit->GetActor()->TakeDamage(Archetype.ExplosionDamage, DmgEvent, InstigatingController, Weapon);
+		}
+
+		if (Archetype.ExplosionDamage > 0 && Archetype.ExplosionRadius > 0)
+		{
+			URadialDamageSubsystem::ApplyRadialDamageWithFalloff(this, Archetype.ExplosionDamage, Archetype.ExplosionMinimumDamage, Location, Archetype.ExplosionInnerRadius, Archetype.ExplosionRadius, Archetype.ExplosionFalloff, Archetype.DamageTypeClass, TArray<AActor*>(), Weapon, InstigatingController);
+		}
+	}
+
+	if (Weapon)
+	{
+		Weapon->OnSimulatedProjectileExploded(Location);
+	}
+
+	RemoveProjectile(Index);
+}
+
+void UProjectileSimulationSubsystem::RemoveProjectile(int32 Index)
+{
+	if (AActor* Visual = VisualActors[Index].Get())
+	{
+		Visual->Destroy();
+	}
+
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	Lifetimes.RemoveAtSwap(Index, 1, false);
+	Bounces.RemoveAtSwap(Index, 1, false);
+	ArchetypeIds.RemoveAtSwap(Index, 1, false);
+	Weapons.RemoveAtSwap(Index, 1, false);
+	IgnoredActors.RemoveAtSwap(Index, 1, false);
+	InstigatingControllers.RemoveAtSwap(Index, 1, false);
+	VisualActors.RemoveAtSwap(Index, 1, false);
+	Authoritative.RemoveAtSwap(Index, 1, false);
+
+	DEC_DWORD_STAT(STAT_SimulatedProjectiles);
+}
@@ -0,0 +1,320 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/RadialDamageSubsystem.h"
+
+#include "Characters/Components/HealthComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/DamageType.h"
+#include "GDKStats.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("RadialDamage Apply"), STAT_RadialDamageApply, STATGROUP_GDKShooter);
+DECLARE_CYCLE_STAT(TEXT("RadialDamage Rebuild Hash"), STAT_RadialDamageRebuild, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RadialDamage Candidates"), STAT_RadialDamageCandidates, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RadialDamage Occlusion Traces"), STAT_RadialDamageTraces, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RadialDamage Unregistered Victims"), STAT_RadialDamageUnregisteredVictims, STATGROUP_GDKShooter);
+
+void URadialDamageSubsystem::Deinitialize()
+{
+	Damageables.Empty();
+	DamageableIndices.Empty();
+	InstancedDamageables.Empty();
+	Cells.Empty();
+	Bounds.Empty();
+	InstancedBounds.Empty();
+	RegisteredActors.Empty();
+
+	Super::Deinitialize();
+}
+
+void URadialDamageSubsystem::RegisterDamageable(UHealthComponent* HealthComponent)
+{
+	if (HealthComponent && !DamageableIndices.Contains(HealthComponent))
+	{
+		DamageableIndices.Add(HealthComponent, Damageables.Add(HealthComponent));
+		LastRebuildFrame = MAX_uint64;
+	}
+}
+
+void URadialDamageSubsystem::UnregisterDamageable(UHealthComponent* HealthComponent)
+{
+	int32 Index;
+	if (!DamageableIndices.RemoveAndCopyValue(HealthComponent, Index))
+	{
+		return;
+	}
+
+	Damageables.RemoveAtSwap(Index, 1, false);
+	if (Damageables.IsValidIndex(Index))
+	{
+		if (UHealthComponent* Moved = Damageables[Index].Get())
+		{
+			DamageableIndices.Add(Moved, Index);
+		}
+	}
+	LastRebuildFrame = MAX_uint64;
+}
+
+void URadialDamageSubsystem::RegisterInstancedDamageable(AActor* Actor)
+{
+	if (Actor)
+	{
+		InstancedDamageables.AddUnique(Actor);
+		LastRebuildFrame = MAX_uint64;
+	}
+}
+
+void URadialDamageSubsystem::UnregisterInstancedDamageable(AActor* Actor)
+{
+	InstancedDamageables.RemoveSingleSwap(Actor, false);
+	LastRebuildFrame = MAX_uint64;
+}
+
+FIntVector URadialDamageSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void URadialDamageSubsystem::RebuildSpatialHashIfStale()
+{
+	if (LastRebuildFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RadialDamageRebuild);
+	LastRebuildFrame = GFrameCounter;
+
+	// Keep the per-cell allocations, most cells are reused from frame to frame.
+	for (auto& Cell : Cells)
+	{
+		Cell.Value.Reset();
+	}
+
+	MaxBoundsExtent = 0.0f;
+	RegisteredActors.Reset();
+	InstancedBounds.Reset();
+	for (const TWeakObjectPtr<AActor>& Actor : InstancedDamageables)
+	{
+		RegisteredActors.Add(Actor.Get());
+		InstancedBounds.Add(Actor.IsValid() ? Actor->GetComponentsBoundingBox(true) : FBox(ForceInit));
+	}
+
+	Bounds.SetNumUninitialized(Damageables.Num(), false);
+	for (int32 Index = 0; Index < Damageables.Num(); Index++)
+	{
+		const UHealthComponent* HealthComponent = Damageables[Index].Get();
+		const AActor* Owner = HealthComponent ? HealthComponent->GetOwner() : nullptr;
+		const USceneComponent* Root = Owner ? Owner->GetRootComponent() : nullptr;
+		if (!Root)
+		{
+			continue;
+		}
+
+		RegisteredActors.Add(Owner);
+
+		// Actors are hashed by their root's bounds centre; queries widen by the largest extent so overlapping bounds are still found.
+		Bounds[Index] = Root->Bounds.GetBox();
+		MaxBoundsExtent = FMath::Max(MaxBoundsExtent, Root->Bounds.BoxExtent.GetMax());
+		Cells.FindOrAdd(GetCell(Root->Bounds.Origin)).Add(Index);
+	}
+}
+
+bool URadialDamageSubsystem::ApplyRadialDamageWithFalloff(const UObject* WorldContextObject, float BaseDamage, float MinimumDamage, const FVector& Origin, float DamageInnerRadius, float DamageOuterRadius, float DamageFalloff, TSubclassOf<UDamageType> DamageTypeClass, const TArray<AActor*>& IgnoreActors, AActor* DamageCauser, AController* InstigatedByController, ECollisionChannel DamagePreventionChannel)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	URadialDamageSubsystem* RadialDamage = World ? World->GetSubsystem<URadialDamageSubsystem>() : nullptr;
+	if (!RadialDamage)
+	{
+		return UGameplayStatics::ApplyRadialDamageWithFalloff(WorldContextObject, BaseDamage, MinimumDamage, Origin, DamageInnerRadius, DamageOuterRadius, DamageFalloff, DamageTypeClass, IgnoreActors, DamageCauser, InstigatedByController, DamagePreventionChannel);
+	}
+
+	return RadialDamage->ApplyRadialDamage(BaseDamage, MinimumDamage, Origin, DamageInnerRadius, DamageOuterRadius, DamageFalloff, DamageTypeClass, IgnoreActors, DamageCauser, InstigatedByController, DamagePreventionChannel);
+}
+
+bool URadialDamageSubsystem::ApplyRadialDamage(float BaseDamage, float MinimumDamage, const FVector& Origin, float DamageInnerRadius, float DamageOuterRadius, float DamageFalloff, TSubclassOf<UDamageType> DamageTypeClass, const TArray<AActor*>& IgnoreActors, AActor* DamageCauser, AController* InstigatedByController, ECollisionChannel DamagePreventionChannel)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RadialDamageApply);
+
+	if (DamageOuterRadius <= 0.0f)
+	{
+		return false;
+	}
+
+	RebuildSpatialHashIfStale();
+
+	FRadialDamageEvent DmgEvent;
+	DmgEvent.DamageTypeClass = DamageTypeClass ? DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+	DmgEvent.Origin = Origin;
+	DmgEvent.Params = FRadialDamageParams(BaseDamage, MinimumDamage, DamageInnerRadius, DamageOuterRadius, DamageFalloff);
+
+	// Gather everything registered in the cells overlapping the explosion bounds.
+	Candidates.Reset();
+	const FIntVector MinCell = GetCell(Origin - FVector(DamageOuterRadius + MaxBoundsExtent));
+	const FIntVector MaxCell = GetCell(Origin + FVector(DamageOuterRadius + MaxBoundsExtent));
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				if (const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					Candidates.Append(*Cell);
+				}
+			}
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_RadialDamageCandidates, Candidates.Num());
+
+	// Distance to the closest point on each candidate's bounds in one pass over contiguous data, so actors that only
+	// reach into the explosion with their bounds are hit, as with the engine's overlap.
+	DistancesSquared.SetNumUninitialized(Candidates.Num(), false);
+	for (int32 i = 0; i < Candidates.Num(); i++)
+	{
+		DistancesSquared[i] = Bounds[Candidates[i]].ComputeSquaredDistanceToPoint(Origin);
+	}
+
+	const float OuterRadiusSquared = FMath::Square(DamageOuterRadius);
+	TArray<FHitResult, TInlineAllocator<16>> Victims;
+	for (int32 i = 0; i < Candidates.Num(); i++)
+	{
+		if (DistancesSquared[i] > OuterRadiusSquared)
+		{
+			continue;
+		}
+
+		const float DamageScale = DmgEvent.Params.GetDamageScale(FMath::Sqrt(DistancesSquared[i]));
+		if (FMath::Lerp(MinimumDamage, BaseDamage, FMath::Max(0.f, DamageScale)) <= 0.0f)
+		{
+			continue;
+		}
+
+		const UHealthComponent* HealthComponent = Damageables[Candidates[i]].Get();
+		AActor* Victim = HealthComponent ? HealthComponent->GetOwner() : nullptr;
+		if (!Victim || !Victim->CanBeDamaged() || IgnoreActors.Contains(Victim))
+		{
+			continue;
+		}
+
+		// The victim scales damage by the distance to ImpactPoint, so use the closest point on its bounds.
+		// Occlusion is traced towards the bounds centre, as UGameplayStatics does.
+		const FBox& VictimBounds = Bounds[Candidates[i]];
+		FHitResult& Hit = Victims.AddDefaulted_GetRef();
+		Hit.Actor = Victim;
+		Hit.Component = Cast<UPrimitiveComponent>(Victim->GetRootComponent());
+		Hit.TraceStart = Origin;
+		Hit.TraceEnd = VictimBounds.GetCenter();
+		Hit.Location = VictimBounds.GetClosestPointTo(Origin);
+		Hit.ImpactPoint = Hit.Location;
+		Hit.ImpactNormal = (Origin - Hit.TraceEnd).GetSafeNormal();
+		Hit.Normal = Hit.ImpactNormal;
+		Hit.bBlockingHit = true;
+	}
+
+	// Occlusion traces for the survivors only, back to back.
+	if (DamagePreventionChannel != ECC_MAX)
+	{
+		UWorld* World = GetWorld();
+		FCollisionQueryParams LineParams(SCENE_QUERY_STAT(RadialDamageOcclusion), false);
+
+		for (int32 i = Victims.Num() - 1; i >= 0; i--)
+		{
+			INC_DWORD_STAT(STAT_RadialDamageTraces);
+
+			FHitResult Blocker;
+			LineParams.ClearIgnoredActors();
+			LineParams.AddIgnoredActors(IgnoreActors);
+			LineParams.AddIgnoredActor(Victims[i].GetActor());
+			if (World->LineTraceSingleByChannel(Blocker, Origin, Victims[i].TraceEnd, DamagePreventionChannel, LineParams))
+			{
+				Victims.RemoveAtSwap(i, 1, false);
+			}
+		}
+	}
+
+	// Apply last, damage can destroy actors and unregister them from the hash.
+	for (const FHitResult& Hit : Victims)
+	{
+		if (AActor* Victim = Hit.GetActor())
+		{
+			DmgEvent.ComponentHits.Reset();
+			DmgEvent.ComponentHits.Add(Hit);
+			Victim->TakeDamage(BaseDamage, DmgEvent, InstigatedByController, DamageCauser);
+		}
+	}
+
+	// Instanced damageables resolve their pieces from the origin and radii in the event, and trace occlusion per piece.
+	// Each one reached is a cross-server record, so explosions that miss their bounds are not sent.
+	DmgEvent.ComponentHits.Reset();
+	for (int32 i = InstancedDamageables.Num() - 1; i >= 0; i--)
+	{
+		AActor* Victim = InstancedDamageables[i].Get();
+		if (Victim && Victim->CanBeDamaged() && !IgnoreActors.Contains(Victim)
+			&& InstancedBounds.IsValidIndex(i) && InstancedBounds[i].IsValid && InstancedBounds[i].ComputeSquaredDistanceToPoint(Origin) <= OuterRadiusSquared)
+		{
+			Victim->TakeDamage(BaseDamage, DmgEvent, InstigatedByController, DamageCauser);
+		}
+	}
+
+	const bool bDamagedUnregistered = ApplyToUnregisteredActors(DmgEvent, BaseDamage, IgnoreActors, DamageCauser, InstigatedByController, DamagePreventionChannel);
+	return Victims.Num() > 0 || bDamagedUnregistered;
+}
+
+bool URadialDamageSubsystem::ApplyToUnregisteredActors(const FRadialDamageEvent& DmgEvent, float BaseDamage, const TArray<AActor*>& IgnoreActors, AActor* DamageCauser, AController* InstigatedByController, ECollisionChannel DamagePreventionChannel)
+{
+	UWorld* World = GetWorld();
+	FCollisionQueryParams SphereParams(SCENE_QUERY_STAT(RadialDamageUnregistered), false, DamageCauser);
+	SphereParams.AddIgnoredActors(IgnoreActors);
+
+	Overlaps.Reset();
+	World->OverlapMultiByObjectType(Overlaps, DmgEvent.Origin, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects), FCollisionShape::MakeSphere(DmgEvent.Params.OuterRadius), SphereParams);
+
+	// Registered actors were handled above, so only their components' occlusion traces are saved here, which is most of the cost.
+	TMap<AActor*, TArray<FHitResult>> ComponentHits;
+	FCollisionQueryParams LineParams(SCENE_QUERY_STAT(RadialDamageOcclusion), false, DamageCauser);
+	LineParams.AddIgnoredActors(IgnoreActors);
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* Victim = Overlap.GetActor();
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (!Victim || !Component || Victim == DamageCauser || !Victim->CanBeDamaged() || RegisteredActors.Contains(Victim))
+		{
+			continue;
+		}
+
+		// As UGameplayStatics: traced to the component's bounds centre, and damageable unless something else blocks the trace first.
+		const FVector TraceEnd = Component->Bounds.Origin;
+		FHitResult Hit;
+		if (DamagePreventionChannel != ECC_MAX)
+		{
+			INC_DWORD_STAT(STAT_RadialDamageTraces);
+			if (World->LineTraceSingleByChannel(Hit, DmgEvent.Origin, TraceEnd, DamagePreventionChannel, LineParams) && Hit.Component != Component)
+			{
+				continue;
+			}
+		}
+
+		if (Hit.Component != Component)
+		{
+			Hit = FHitResult(Victim, Component, TraceEnd, (DmgEvent.Origin - TraceEnd).GetSafeNormal());
+			Hit.TraceStart = DmgEvent.Origin;
+			Hit.TraceEnd = TraceEnd;
+		}
+		ComponentHits.FindOrAdd(Victim).Add(Hit);
+	}
+
+	INC_DWORD_STAT_BY(STAT_RadialDamageUnregisteredVictims, ComponentHits.Num());
+
+	FRadialDamageEvent VictimEvent = DmgEvent;
+	for (TPair<AActor*, TArray<FHitResult>>& Entry : ComponentHits)
+	{
+		VictimEvent.ComponentHits = MoveTemp(Entry.Value);
+		Entry.Key->TakeDamage(BaseDamage, VictimEvent, InstigatedByController, DamageCauser);
+	}
+
+	return ComponentHits.Num() > 0;
+}
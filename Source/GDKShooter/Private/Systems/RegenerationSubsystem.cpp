@@ -0,0 +1,130 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/RegenerationSubsystem.h"
+
+#include "Characters/Components/HealthComponent.h"
+#include "Engine/World.h"
+#include "GDKStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Regeneration Update"), STAT_RegenerationUpdate, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Regeneration Grants"), STAT_RegenerationGrants, STATGROUP_GDKShooter);
+
+namespace
+{
+	// Number of whole intervals that have come due by Now, advancing NextTime past them.
+	int32 ConsumeDueIntervals(float Now, float Interval, float& NextTime)
+	{
+		if (Interval <= 0.0f || Now < NextTime)
+		{
+			return 0;
+		}
+
+		const int32 Count = FMath::FloorToInt((Now - NextTime) / Interval) + 1;
+		NextTime += Count * Interval;
+		return Count;
+	}
+}
+
+void URegenerationSubsystem::Deinitialize()
+{
+	Components.Empty();
+	Rates.Empty();
+	NextHealthTimes.Empty();
+	NextArmourTimes.Empty();
+	ComponentIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+bool URegenerationSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && Components.Num() > 0;
+}
+
+TStatId URegenerationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URegenerationSubsystem, STATGROUP_Tickables);
+}
+
+void URegenerationSubsystem::RegisterRegeneration(UHealthComponent* HealthComponent, const FRegenerationRates& InRates)
+{
+	if (HealthComponent == nullptr || ComponentIndices.Contains(HealthComponent))
+	{
+		return;
+	}
+
+	ComponentIndices.Add(HealthComponent, Components.Add(HealthComponent));
+	Rates.Add(InRates);
+	NextHealthTimes.Add(MAX_flt);
+	NextArmourTimes.Add(MAX_flt);
+}
+
+void URegenerationSubsystem::UnregisterRegeneration(UHealthComponent* HealthComponent)
+{
+	int32 Index;
+	if (ComponentIndices.RemoveAndCopyValue(HealthComponent, Index))
+	{
+		RemoveAt(Index);
+	}
+}
+
+void URegenerationSubsystem::RemoveAt(int32 Index)
+{
+	Components.RemoveAtSwap(Index, 1, false);
+	Rates.RemoveAtSwap(Index, 1, false);
+	NextHealthTimes.RemoveAtSwap(Index, 1, false);
+	NextArmourTimes.RemoveAtSwap(Index, 1, false);
+
+	if (Components.IsValidIndex(Index))
+	{
+		if (UHealthComponent* Moved = Components[Index].Get())
+		{
+			ComponentIndices.Add(Moved, Index);
+		}
+	}
+}
+
+void URegenerationSubsystem::NotifyDamaged(UHealthComponent* HealthComponent, const FRegenerationRates& InRates)
+{
+	const int32* Index = ComponentIndices.Find(HealthComponent);
+	if (Index == nullptr)
+	{
+		return;
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	Rates[*Index] = InRates;
+	NextHealthTimes[*Index] = InRates.HealthInterval > 0.0f ? Now + InRates.HealthCooldown : MAX_flt;
+	NextArmourTimes[*Index] = InRates.ArmourInterval > 0.0f ? Now + InRates.ArmourCooldown : MAX_flt;
+}
+
+void URegenerationSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval)
+	{
+		return;
+	}
+	TimeSinceUpdate = FMath::Fmod(TimeSinceUpdate, UpdateInterval);
+
+	SCOPE_CYCLE_COUNTER(STAT_RegenerationUpdate);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = 0; i < Components.Num(); i++)
+	{
+		const int32 HealthCount = ConsumeDueIntervals(Now, Rates[i].HealthInterval, NextHealthTimes[i]);
+		const int32 ArmourCount = ConsumeDueIntervals(Now, Rates[i].ArmourInterval, NextArmourTimes[i]);
+		if (HealthCount == 0 && ArmourCount == 0)
+		{
+			continue;
+		}
+
+		// Components unregister themselves in EndPlay, so a stale entry only lingers until then.
+		if (UHealthComponent* HealthComponent = Components[i].Get())
+		{
+			INC_DWORD_STAT(STAT_RegenerationGrants);
+			HealthComponent->Regenerate(HealthCount * Rates[i].HealthValue, ArmourCount * Rates[i].ArmourValue);
+		}
+	}
+}
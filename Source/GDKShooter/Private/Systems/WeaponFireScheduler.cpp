@@ -0,0 +1,60 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Systems/WeaponFireScheduler.h"
+
+#include "Engine/World.h"
+#include "GDKStats.h"
+#include "Kismet/GameplayStatics.h"
+#include "Weapons/Weapon.h"
+
+DECLARE_CYCLE_STAT(TEXT("WeaponFireScheduler Tick"), STAT_WeaponFireSchedulerTick, STATGROUP_GDKShooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Scheduled Weapon Fires"), STAT_ScheduledWeaponFires, STATGROUP_GDKShooter);
+
+void UWeaponFireScheduler::Deinitialize()
+{
+	Heap.Empty();
+	Due.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UWeaponFireScheduler::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && Heap.Num() > 0;
+}
+
+TStatId UWeaponFireScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponFireScheduler, STATGROUP_Tickables);
+}
+
+void UWeaponFireScheduler::ScheduleFire(AWeapon* Weapon, float FireTime, uint32 Generation)
+{
+	Heap.HeapPush(FScheduledFire{ FireTime, Weapon, Generation }, FScheduledFirePredicate());
+	SET_DWORD_STAT(STAT_ScheduledWeaponFires, Heap.Num());
+}
+
+void UWeaponFireScheduler::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponFireSchedulerTick);
+
+	const float Now = UGameplayStatics::GetRealTimeSeconds(GetWorld());
+
+	Due.Reset();
+	while (Heap.Num() > 0 && Heap.HeapTop().FireTime <= Now)
+	{
+		FScheduledFire Entry;
+		Heap.HeapPop(Entry, FScheduledFirePredicate(), false);
+		Due.Add(Entry);
+	}
+
+	for (const FScheduledFire& Entry : Due)
+	{
+		if (AWeapon* Weapon = Entry.Weapon.Get())
+		{
+			Weapon->ProcessScheduledFire(Entry.Generation);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ScheduledWeaponFires, Heap.Num());
+}
@@ -13,6 +13,7 @@
 #include "EngineClasses/SpatialGameInstance.h"
 #include "Interop/Connection/SpatialConnectionManager.h"
 #include "Game/Components/TeamDeathmatchScoreComponent.h"
+#include "Systems/GDKComponentRegistry.h"
 
 // Register listeners on AGDKPlayerController and AGDKGameState
 void UGDKWidget::NativeConstruct()
@@ -39,7 +40,7 @@ void UGDKWidget::NativeConstruct()
 		OnPawn(GDKPlayerController->GetPawn());
 	}
 
-	if (UControllerEventsComponent* ControllerEvents = Cast<UControllerEventsComponent>(PlayerController->GetComponentByClass(UControllerEventsComponent::StaticClass())))
+	if (UControllerEventsComponent* ControllerEvents = UGDKComponentRegistry::Find<UControllerEventsComponent>(PlayerController))
 	{
 		ControllerEvents->KillDetailsEvent.AddDynamic(this, &UGDKWidget::OnKill);
 		ControllerEvents->DeathDetailsEvent.AddDynamic(this, &UGDKWidget::OnDeath);
@@ -89,12 +90,12 @@ void UGDKWidget::OnPawn(APawn* InPawn)
 		return;
 	}
 
-	if (UGDKMovementComponent* Movement = Cast< UGDKMovementComponent>(InPawn->GetComponentByClass(UGDKMovementComponent::StaticClass())))
+	if (UGDKMovementComponent* Movement = UGDKComponentRegistry::Find<UGDKMovementComponent>(InPawn))
 	{
 		Movement->OnAimingUpdated.AddUniqueDynamic(this, &UGDKWidget::OnAimingUpdated);
 	}
 
-	if (UHealthComponent* Health = Cast< UHealthComponent>(InPawn->GetComponentByClass(UHealthComponent::StaticClass())))
+	if (UHealthComponent* Health = UGDKComponentRegistry::Find<UHealthComponent>(InPawn))
 	{
 		Health->HealthUpdated.AddUniqueDynamic(this, &UGDKWidget::OnHealthUpdated);
 		Health->ArmourUpdated.AddUniqueDynamic(this, &UGDKWidget::OnArmourUpdated);
@@ -102,7 +103,7 @@ void UGDKWidget::OnPawn(APawn* InPawn)
 		OnArmourUpdated(Health->GetCurrentArmour(), Health->GetMaxArmour());
 	}
 
-	if (UShootingComponent* Shooting = Cast< UShootingComponent>(InPawn->GetComponentByClass(UShootingComponent::StaticClass())))
+	if (UShootingComponent* Shooting = UGDKComponentRegistry::Find<UShootingComponent>(InPawn))
 	{
 		Shooting->ShotEvent.AddUniqueDynamic(this, &UGDKWidget::OnShot);
 	}
@@ -0,0 +1,31 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Weapons/HitboxCollision.h"
+#include "Components/ShapeComponent.h"
+
+const FName HitboxCollision::ProfileName(TEXT("Hitbox"));
+
+void HitboxCollision::ConfigureHitbox(UShapeComponent* Shape)
+{
+	if (Shape == nullptr)
+	{
+		return;
+	}
+
+	Shape->SetCollisionProfileName(ProfileName);
+	Shape->SetGenerateOverlapEvents(false);
+	Shape->SetCanEverAffectNavigation(false);
+	Shape->bTraceComplexOnMove = false;
+	Shape->bReturnMaterialOnMove = false;
+	Shape->SetHiddenInGame(true);
+}
+
+void HitboxCollision::IgnoreWeaponTraces(UPrimitiveComponent* Component)
+{
+	if (Component == nullptr)
+	{
+		return;
+	}
+
+	Component->SetCollisionResponseToChannel(ECC_WeaponTrace, ECR_Ignore);
+}
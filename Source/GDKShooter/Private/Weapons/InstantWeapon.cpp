@@ -6,8 +6,12 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/DamageType.h"
 #include "GDKLogging.h"
+#include "GDKStats.h"
 #include "Net/UnrealNetwork.h"
 
+DECLARE_CYCLE_STAT(TEXT("InstantWeapon Fire"), STAT_InstantWeaponFire, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("InstantWeapon Shots Accepted"), STAT_InstantWeaponShotsAccepted, STATGROUP_GDKShooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("InstantWeapon Shots Rate Limited"), STAT_InstantWeaponShotsRateLimited, STATGROUP_GDKShooter);
 
 AInstantWeapon::AInstantWeapon()
 {
@@ -20,6 +24,7 @@ AInstantWeapon::AInstantWeapon()
 	HitValidationTolerance = 50.0f;
 	DamageTypeClass = UDamageType::StaticClass();  // generic damage type
 	ShotVisualizationDelayTolerance = FTimespan::FromMilliseconds(3000.0f);
+	DamagePolicy = &FPointDamagePolicy::Apply;
 }
 
 void AInstantWeapon::StartPrimaryUse_Implementation()
@@ -45,6 +50,46 @@ void AInstantWeapon::StopPrimaryUse_Implementation()
 	}
 }
 
+void AInstantWeapon::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BindFirePolicies();
+}
+
+void AInstantWeapon::BindFirePolicies()
+{
+	if (SpreadAt100m > 0 || SpreadAt100mWhenAiming > 0)
+	{
+		BindFireMode<FCircleSpread>();
+	}
+	else
+	{
+		BindFireMode<FNoSpread>();
+	}
+}
+
+template<typename SpreadPolicy>
+void AInstantWeapon::BindFireMode()
+{
+	if (IsFullyAutomatic())
+	{
+		FireFunction = &AInstantWeapon::FireShot<FAutomaticFireMode, SpreadPolicy>;
+	}
+	else if (bAllowContinuousBurstFire)
+	{
+		FireFunction = &AInstantWeapon::FireShot<FContinuousBurstFireMode, SpreadPolicy>;
+	}
+	else if (BurstCount == 1)
+	{
+		FireFunction = &AInstantWeapon::FireShot<FSingleShotFireMode, SpreadPolicy>;
+	}
+	else
+	{
+		FireFunction = &AInstantWeapon::FireShot<FBurstFireMode, SpreadPolicy>;
+	}
+}
+
 void AInstantWeapon::DoFire_Implementation()
 {
 	if (!bIsActive)
@@ -54,51 +99,102 @@ void AInstantWeapon::DoFire_Implementation()
 		return;
 	}
 
+	SCOPE_CYCLE_COUNTER(STAT_InstantWeaponFire);
+
 	NextShotTime = UGameplayStatics::GetRealTimeSeconds(GetWorld()) + ShotInterval;
-	
-	FInstantHitInfo HitInfo = DoLineTrace();
-	if (HitInfo.bDidHit)
+
+	if (FireFunction == nullptr)
 	{
-		ServerDidHit(HitInfo);
-		SpawnFX(HitInfo, true);  // Spawn the hit fx locally
-		AnnounceShot(HitInfo.HitActor ? HitInfo.HitActor->CanBeDamaged() : false);
+		BindFirePolicies();
+	}
+	(this->*FireFunction)();
+}
+
+template<typename FireModePolicy, typename SpreadPolicy>
+void AInstantWeapon::FireShot()
+{
+	const FVector AimDirection = AWeapon::GetLineTraceDirection();
+	const float SpreadToUse = SpreadPolicy::bUsesSpread ? GetCurrentSpread() : 0.0f;
+
+	if (PelletsPerShot > 1 && GetShootingComponent())
+	{
+		TArray<FVector> Directions;
+		Directions.Reserve(PelletsPerShot);
+		for (int32 i = 0; i < PelletsPerShot; i++)
+		{
+			Directions.Add(SpreadPolicy::Apply(AimDirection, SpreadToUse));
+		}
+
+		// Shots fired on the server (e.g. by NPCs) are authoritative and resolved immediately, clients get results next frame.
+		const bool bSynchronous = GetNetMode() < NM_Client;
+		GetShootingComponent()->DoLineTraceBatch(Directions, this, FInstantHitBatchDelegate::CreateUObject(this, &AInstantWeapon::OnPelletTracesCompleted), bSynchronous);
+	}
+	else if (GetShootingComponent())
+	{
+		FInstantHitInfo HitInfo = GetShootingComponent()->DoLineTrace(SpreadPolicy::Apply(AimDirection, SpreadToUse), this);
+		ProcessShot(HitInfo);
+		AnnounceShot(HitInfo.bDidHit && HitInfo.HitActor ? HitInfo.HitActor->CanBeDamaged() : false);
 	}
 	else
 	{
-		ServerDidMiss(HitInfo);
-		SpawnFX(HitInfo, false);  // Spawn the hit fx locally
-		AnnounceShot(false);
+		UE_LOG(LogGDK, Error, TEXT("%s requires a UShootingComponent on its Owner"), *this->GetName());
 	}
 
-	if (IsBurstFire())
+	bool bFinishedBurst = FireModePolicy::bSingleShot;
+	if (FireModePolicy::bCountsBurst)
 	{
 		--BurstShotsRemaining;
-		if (BurstShotsRemaining <= 0)
+		bFinishedBurst = BurstShotsRemaining <= 0;
+	}
+
+	if (bFinishedBurst)
+	{
+		FinishedBurst();
+		if (FireModePolicy::bRepeatsBurst)
 		{
-			FinishedBurst();
-			if (bAllowContinuousBurstFire)
-			{
-				BurstShotsRemaining = BurstCount;
-				// We will force a cooldown for the full burst interval, regardless of the time already consumed in the previous burst, for simplicity.
-				ForceCooldown(BurstInterval);
-			}
-			else
+			BurstShotsRemaining = BurstCount;
+			// We will force a cooldown for the full burst interval, regardless of the time already consumed in the previous burst, for simplicity.
+			ForceCooldown(BurstInterval);
+		}
+		else
+		{
+			if (GetMovementComponent())
 			{
-				if (GetMovementComponent())
-				{
-					GetMovementComponent()->SetIsBusy(false);
-				}
-				IsPrimaryUsing = false;
+				GetMovementComponent()->SetIsBusy(false);
 			}
+			IsPrimaryUsing = false;
 		}
 	}
+}
 
+void AInstantWeapon::ProcessShot(const FInstantHitInfo& HitInfo)
+{
+	if (HitInfo.bDidHit)
+	{
+		ServerDidHit(HitInfo);
+		SpawnFX(HitInfo, true);  // Spawn the hit fx locally
+	}
+	else
+	{
+		ServerDidMiss(HitInfo);
+		SpawnFX(HitInfo, false);  // Spawn the hit fx locally
+	}
 }
 
-FVector AInstantWeapon::GetLineTraceDirection()
+void AInstantWeapon::OnPelletTracesCompleted(const TArray<FInstantHitInfo>& HitInfos)
 {
-	FVector Direction = Super::GetLineTraceDirection();
+	bool bHitDamageable = false;
+	for (const FInstantHitInfo& HitInfo : HitInfos)
+	{
+		ProcessShot(HitInfo);
+		bHitDamageable |= HitInfo.bDidHit && HitInfo.HitActor && HitInfo.HitActor->CanBeDamaged();
+	}
+
+	AnnounceShot(bHitDamageable);
+}
 
+float AInstantWeapon::GetCurrentSpread()
+{
 	float SpreadToUse = SpreadAt100m;
 	if (GetMovementComponent())
 	{
@@ -111,14 +207,12 @@ FVector AInstantWeapon::GetLineTraceDirection()
 			SpreadToUse *= SpreadCrouchModifier;
 		}
 	}
+	return SpreadToUse;
+}
 
-	if (SpreadToUse > 0)
-	{
-		auto Spread = FMath::RandPointInCircle(SpreadToUse);
-		Direction = Direction.Rotation().RotateVector(FVector(10000, Spread.X, Spread.Y));
-	}
-
-	return Direction;
+FVector AInstantWeapon::GetLineTraceDirection()
+{
+	return FCircleSpread::Apply(Super::GetLineTraceDirection(), GetCurrentSpread());
 }
 
 void AInstantWeapon::NotifyClientsOfHit(const FInstantHitInfo& HitInfo, bool bImpact)
@@ -172,16 +266,50 @@ bool AInstantWeapon::ValidateHit(const FInstantHitInfo& HitInfo)
 
 void AInstantWeapon::DealDamage(const FInstantHitInfo& HitInfo)
 {
-	FPointDamageEvent DmgEvent;
-	DmgEvent.DamageTypeClass = DamageTypeClass;
-	DmgEvent.HitInfo.ImpactPoint = HitInfo.Location;
-
 	if (APawn* Pawn = Cast<APawn>(GetOwner()))
 	{
-		HitInfo.HitActor->TakeDamage(ShotBaseDamage, DmgEvent, Pawn->GetController(), this);
+		DamagePolicy(HitInfo, FInstantDamageParams{ ShotBaseDamage, DamageTypeClass, Pawn->GetController(), this });
 	}
 }
 
+void AInstantWeapon::ConfigureRateLimiter()
+{
+	// Sustained shots per second and how many can arrive back to back, for one pellet per shot.
+	float ShotsPerSecond = 0.0f;
+	float MaxBurst = 1.0f;
+	if (IsBurstFire())
+	{
+		const float BurstDuration = FMath::Max(BurstInterval, BurstCount * ShotInterval);
+		ShotsPerSecond = BurstDuration > 0.0f ? BurstCount / BurstDuration : 0.0f;
+		MaxBurst = BurstCount;
+	}
+	else
+	{
+		ShotsPerSecond = ShotInterval > 0.0f ? 1.0f / ShotInterval : 0.0f;
+	}
+
+	const int32 Pellets = FMath::Max(PelletsPerShot, 1);
+	ShotRateLimiter.Configure(ShotsPerSecond * (1.0f + RateLimitJitterTolerance) * Pellets, (MaxBurst + RateLimitBurstAllowance) * Pellets);
+}
+
+bool AInstantWeapon::ConsumeShotToken()
+{
+	if (!ShotRateLimiter.IsConfigured())
+	{
+		ConfigureRateLimiter();
+	}
+
+	if (!ShotRateLimiter.TryConsume(UGameplayStatics::GetRealTimeSeconds(GetWorld())))
+	{
+		INC_DWORD_STAT(STAT_InstantWeaponShotsRateLimited);
+		UE_LOG(LogGDK, Verbose, TEXT("%s server: dropped shot over the fire rate"), *this->GetName());
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_InstantWeaponShotsAccepted);
+	return true;
+}
+
 bool AInstantWeapon::ServerDidHit_Validate(const FInstantHitInfo& HitInfo)
 {
 	return true;
@@ -189,6 +317,11 @@ bool AInstantWeapon::ServerDidHit_Validate(const FInstantHitInfo& HitInfo)
 
 void AInstantWeapon::ServerDidHit_Implementation(const FInstantHitInfo& HitInfo)
 {
+	// Dropped rather than failing validation, so that jitter beyond the tolerance doesn't disconnect legitimate players.
+	if (!ConsumeShotToken())
+	{
+		return;
+	}
 
 	bool bDoNotifyHit = false;
 
@@ -222,6 +355,11 @@ bool AInstantWeapon::ServerDidMiss_Validate(const FInstantHitInfo& HitInfo)
 
 void AInstantWeapon::ServerDidMiss_Implementation(const FInstantHitInfo& HitInfo)
 {
+	if (!ConsumeShotToken())
+	{
+		return;
+	}
+
 	NotifyClientsOfHit(HitInfo, false);
 }
 
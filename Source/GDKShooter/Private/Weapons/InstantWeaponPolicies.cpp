@@ -0,0 +1,29 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#include "Weapons/InstantWeaponPolicies.h"
+
+#include "Buildable.h"
+#include "BuildableManager.h"
+#include "GameFramework/Actor.h"
+
+void FPointDamagePolicy::Apply(const FInstantHitInfo& HitInfo, const FInstantDamageParams& Params)
+{
+	FPointDamageEvent DmgEvent;
+	DmgEvent.DamageTypeClass = Params.DamageTypeClass;
+	DmgEvent.HitInfo.ImpactPoint = HitInfo.Location;
+	DmgEvent.HitInfo.Item = HitInfo.HitItem;
+
+	HitInfo.HitActor->TakeDamage(Params.BaseDamage, DmgEvent, Params.Instigator, Params.DamageCauser);
+}
+
+void FBuildRepairDamagePolicy::Apply(const FInstantHitInfo& HitInfo, const FInstantDamageParams& Params)
+{
+	if (ABuildable* Buildable = Cast<ABuildable>(HitInfo.HitActor))
+	{
+		Buildable->Build(RepairPerShot);
+	}
+	else if (ABuildableManager* BuildableManager = Cast<ABuildableManager>(HitInfo.HitActor))
+	{
+		BuildableManager->RepairAt(HitInfo.Location, RepairPerShot, HitInfo.HitItem);
+	}
+}
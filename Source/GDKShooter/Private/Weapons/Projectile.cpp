@@ -2,11 +2,15 @@
 
 #include "Weapons/Projectile.h"
 #include "Kismet/GameplayStatics.h"
+#include "Systems/RadialDamageSubsystem.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
 #include "GameFramework/Pawn.h"
 #include "GDKLogging.h"
 #include "Net/UnrealNetwork.h"
+#include "Systems/ProjectilePoolSubsystem.h"
+#include "TimerManager.h"
 
 AProjectile::AProjectile(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -50,6 +54,21 @@ void AProjectile::PostInitializeComponents()
 	MovementComp->OnProjectileBounce.AddDynamic(this, &AProjectile::OnBounce);
 	CollisionComp->OnComponentBeginOverlap.AddDynamic(this, &AProjectile::BeginOverlap);
 	BeginTime = UGameplayStatics::GetRealTimeSeconds(GetWorld());
+
+	if (bReplicateSpawnParams)
+	{
+		SetReplicatingMovement(false);
+	}
+}
+
+void AProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bReplicateSpawnParams && HasAuthority())
+	{
+		RecordLaunch();
+	}
 }
 
 void AProjectile::SetPlayer(AWeapon* Weapon)
@@ -63,12 +82,107 @@ void AProjectile::SetPlayer(AWeapon* Weapon)
 	InstigatingWeapon = Weapon;
 }
 
+void AProjectile::ResetForReuse(const FTransform& SpawnTransform)
+{
+	GetWorldTimerManager().ClearTimer(ReturnToPoolTimer);
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	bPooled = false;
+	bExploded = false;
+	BouncesSoFar = 0;
+	BeginTime = UGameplayStatics::GetRealTimeSeconds(GetWorld());
+	SetCanBeDamaged(true);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	ResetSimulation();
+
+	MovementComp->SetVelocityInLocalSpace(FVector::ForwardVector * MovementComp->InitialSpeed);
+	MovementComp->UpdateComponentVelocity();
+
+	if (bReplicateSpawnParams)
+	{
+		Correction = FProjectileFlightState();
+		RecordLaunch();
+	}
+}
+
+void AProjectile::DeactivateForPool()
+{
+	GetWorldTimerManager().ClearTimer(ReturnToPoolTimer);
+
+	bPooled = true;
+	SetCanBeDamaged(false);
+	MovementComp->StopMovementImmediately();
+	MovementComp->Deactivate();
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	// Ignore lists are rebuilt by SetPlayer when the projectile is next fired.
+	CollisionComp->MoveIgnoreActors.Reset();
+	InstigatingWeapon = nullptr;
+	InstigatingController = nullptr;
+}
+
+FSimulatedProjectileArchetype AProjectile::MakeSimulationArchetype() const
+{
+	FSimulatedProjectileArchetype Archetype;
+	Archetype.Radius = CollisionComp->GetUnscaledSphereRadius();
+	Archetype.GravityScale = MovementComp->ProjectileGravityScale;
+	Archetype.MaxSpeed = MovementComp->MaxSpeed;
+	Archetype.bShouldBounce = MovementComp->bShouldBounce;
+	Archetype.Bounciness = MovementComp->Bounciness;
+	Archetype.Friction = MovementComp->Friction;
+	Archetype.BounceVelocityStopThreshold = MovementComp->BounceVelocityStopSimulatingThreshold;
+
+	Archetype.bExplodeOnStop = ExplodeOnStop;
+	Archetype.MaximumBounces = MaximumBounces;
+	Archetype.LifeTillExplode = LifeTillExplode;
+
+	Archetype.ExplosionDamage = ExplosionDamage;
+	Archetype.ExplosionMinimumDamage = ExplosionMinimumDamage;
+	Archetype.ExplosionRadius = ExplosionRadius;
+	Archetype.ExplosionInnerRadius = ExplosionInnerRadius;
+	Archetype.ExplosionFalloff = ExplosionFalloff;
+	Archetype.DamageTypeClass = DamageTypeClass;
+	return Archetype;
+}
+
+void AProjectile::ResetSimulation()
+{
+	Mesh->SetVisibility(true, true);
+
+	// The movement component detaches from its updated component when the simulation stops.
+	MovementComp->SetUpdatedComponent(CollisionComp);
+	MovementComp->Activate(true);
+}
+
+void AProjectile::ReturnToPool()
+{
+	UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>();
+	if (Pool)
+	{
+		Pool->ReleaseProjectile(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
 void AProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(AProjectile, bExploded);
+	DOREPLIFETIME(AProjectile, bPooled);
 	DOREPLIFETIME(AProjectile, MetaData);
+	DOREPLIFETIME(AProjectile, LaunchState);
+	DOREPLIFETIME(AProjectile, Correction);
 }
 
 void AProjectile::PostNetReceiveVelocity(const FVector& NewVelocity)
@@ -79,6 +193,65 @@ void AProjectile::PostNetReceiveVelocity(const FVector& NewVelocity)
 	}
 }
 
+float AProjectile::GetServerWorldTime() const
+{
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+void AProjectile::RecordLaunch()
+{
+	LaunchState.Location = GetActorLocation();
+	LaunchState.Velocity = MovementComp->Velocity;
+	LaunchState.ServerTime = GetServerWorldTime();
+}
+
+void AProjectile::RecordCorrection()
+{
+	Correction.Location = GetActorLocation();
+	Correction.Velocity = MovementComp->Velocity;
+	Correction.ServerTime = GetServerWorldTime();
+}
+
+void AProjectile::ApplyFlightState(const FProjectileFlightState& State)
+{
+	// Ignores MaxSpeed, which projectiles launched at InitialSpeed under gravity only reach after long flights.
+	const float Elapsed = FMath::Clamp(GetServerWorldTime() - State.ServerTime, 0.0f, LifeTillExplode);
+	const FVector Gravity(0.0f, 0.0f, MovementComp->GetGravityZ());
+
+	const FVector Location = State.Location + State.Velocity * Elapsed + 0.5f * Gravity * Elapsed * Elapsed;
+	SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+
+	MovementComp->Velocity = State.Velocity + Gravity * Elapsed;
+	MovementComp->UpdateComponentVelocity();
+}
+
+void AProjectile::OnRep_LaunchState()
+{
+	if (!bExploded)
+	{
+		ApplyFlightState(LaunchState);
+	}
+}
+
+void AProjectile::OnRep_Correction()
+{
+	// Corrections left over from a previous flight of a pooled projectile are stale.
+	if (Correction.ServerTime < LaunchState.ServerTime)
+	{
+		return;
+	}
+
+	if (bExploded || Correction.Velocity.IsNearlyZero())
+	{
+		SetActorLocation(Correction.Location, false, nullptr, ETeleportType::TeleportPhysics);
+		MovementComp->StopMovementImmediately();
+		return;
+	}
+
+	ApplyFlightState(Correction);
+}
+
 void AProjectile::OnRep_MetaData()
 {
 	OnMetaDataUpdated();
@@ -114,6 +287,8 @@ void AProjectile::OnStop(const FHitResult& ImpactResult)
 		FPointDamageEvent DmgEvent;
 		DmgEvent.DamageTypeClass = DamageTypeClass;
 		DmgEvent.HitInfo.ImpactPoint = ImpactResult.Location;
+		DmgEvent.HitInfo.Component = ImpactResult.Component;
+		DmgEvent.HitInfo.Item = ImpactResult.Item;
 
 		ImpactResult.Actor->TakeDamage(ExplosionDamage, DmgEvent, InstigatingController, this);
 	}
@@ -126,6 +301,11 @@ void AProjectile::OnBounce(const FHitResult& ImpactResult, const FVector& Impact
 		return;
 	}
 
+	if (bReplicateSpawnParams)
+	{
+		RecordCorrection();
+	}
+
 	BouncesSoFar++;
 	if (MaximumBounces >= 0 && BouncesSoFar > MaximumBounces && !bExploded)
 	{
@@ -153,7 +333,30 @@ void AProjectile::OverlapPawn_Implementation(APawn* OtherPawn)
 
 void AProjectile::OnRep_Exploded()
 {
-	ExplosionVisuals();
+	if (bExploded)
+	{
+		// A client that first sees the projectile while it is pooled has missed the explosion.
+		if (!bPooled)
+		{
+			ExplosionVisuals();
+		}
+	}
+	else
+	{
+		ResetSimulation();
+	}
+}
+
+void AProjectile::OnRep_Pooled()
+{
+	if (bPooled)
+	{
+		Mesh->SetVisibility(false, true);
+	}
+	else
+	{
+		ResetSimulation();
+	}
 }
 
 void AProjectile::ExplosionVisuals_Implementation()
@@ -171,9 +374,13 @@ void AProjectile::Explode()
 	SetCanBeDamaged(false);
 	bExploded = true;
 	MovementComp->StopMovementImmediately();
-	SetLifeSpan(2.0f);
+	if (bReplicateSpawnParams)
+	{
+		RecordCorrection();
+	}
+	GetWorldTimerManager().SetTimer(ReturnToPoolTimer, this, &AProjectile::ReturnToPool, ReturnToPoolDelay);
 	if (ExplosionDamage > 0 && ExplosionRadius > 0)
 	{
-		UGameplayStatics::ApplyRadialDamageWithFalloff(this, ExplosionDamage, ExplosionMinimumDamage, this->GetActorLocation(), ExplosionInnerRadius, ExplosionRadius, ExplosionFalloff, DamageTypeClass, TArray<AActor*>{this}, this, InstigatingController);
+		URadialDamageSubsystem::ApplyRadialDamageWithFalloff(this, ExplosionDamage, ExplosionMinimumDamage, this->GetActorLocation(), ExplosionInnerRadius, ExplosionRadius, ExplosionFalloff, DamageTypeClass, TArray<AActor*>{this}, this, InstigatingController);
 	}
 }
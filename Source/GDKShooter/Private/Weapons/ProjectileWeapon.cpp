@@ -7,12 +7,27 @@
 #include "Weapons/Projectile.h"
 #include "GDKLogging.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Systems/ProjectilePoolSubsystem.h"
+#include "Systems/ProjectileSimulationSubsystem.h"
 
 AProjectileWeapon::AProjectileWeapon()
 {
 	ShotCooldown = 1;
 }
 
+void AProjectileWeapon::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority() && !bUseProjectileSimulation)
+	{
+		if (UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>())
+		{
+			Pool->RegisterProjectileClass(ProjectileClass, PoolWarmCount);
+		}
+	}
+}
+
 void AProjectileWeapon::DoFire_Implementation()
 {
 	if (!GetShootingComponent())
@@ -61,8 +76,24 @@ bool AProjectileWeapon::FireProjectile_Validate(FVector Origin, FVector_NetQuant
 
 void AProjectileWeapon::FireProjectile_Implementation(FVector Origin, FVector_NetQuantizeNormal Direction)
 {
+	if (bUseProjectileSimulation)
+	{
+		if (UProjectileSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UProjectileSimulationSubsystem>())
+		{
+			Simulation->SpawnProjectile(ProjectileClass, Origin, Direction, this, true, GetNetMode() == NM_DedicatedServer ? nullptr : ProjectileVisualClass);
+			MulticastProjectileSpawned(Origin, Direction);
+			return;
+		}
+	}
+
 	FTransform SpawnTransformMatrix(Direction.Rotation(), Origin);
 
+	if (UProjectilePoolSubsystem* Pool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>())
+	{
+		Pool->AcquireProjectile(ProjectileClass, SpawnTransformMatrix, this, MetaData);
+		return;
+	}
+
 	AProjectile* Projectile = Cast<AProjectile>(UGameplayStatics::BeginDeferredActorSpawnFromClass(this, ProjectileClass, SpawnTransformMatrix));
 	if (Projectile)
 	{
@@ -72,6 +103,19 @@ void AProjectileWeapon::FireProjectile_Implementation(FVector Origin, FVector_Ne
 	}
 }
 
+void AProjectileWeapon::MulticastProjectileSpawned_Implementation(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction)
+{
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	if (UProjectileSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UProjectileSimulationSubsystem>())
+	{
+		Simulation->SpawnProjectile(ProjectileClass, Origin, Direction, this, false, ProjectileVisualClass);
+	}
+}
+
 void AProjectileWeapon::ConsumeBufferedShot()
 {
 	Super::ConsumeBufferedShot();
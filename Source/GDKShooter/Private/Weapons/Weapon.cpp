@@ -8,16 +8,28 @@
 #include "Kismet/GameplayStatics.h"
 #include "GDKLogging.h"
 #include "Net/UnrealNetwork.h"
+#include "Systems/GDKComponentRegistry.h"
+#include "Systems/WeaponFireScheduler.h"
 
 
 AWeapon::AWeapon()
 {
+	// Firing is driven by UWeaponFireScheduler rather than polled every frame, so native weapons don't tick.
+	// Ticking stays possible for Blueprint subclasses, see BeginPlay.
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.TickGroup = TG_PrePhysics;
 
 	BufferShotThreshold = 0.2f;
 }
 
+void AWeapon::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Keep Event Tick working for Blueprint weapons that implement it, and skip the tick for every other weapon.
+	SetActorTickEnabled(GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AWeapon, ReceiveTick)));
+}
+
 void AWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -58,6 +70,8 @@ void AWeapon::StartPrimaryUse_Implementation()
 	{
 		GetMovementComponent()->SetIsBusy(true);
 	}
+
+	RescheduleFire();
 }
 
 void AWeapon::StopPrimaryUse_Implementation()
@@ -98,7 +112,7 @@ void AWeapon::ForceCooldown(float Cooldown)
 {
 	Super::ForceCooldown(Cooldown);
 	NextShotTime = FMath::Max(NextShotTime, UGameplayStatics::GetRealTimeSeconds(GetWorld()) + Cooldown);
-
+	RescheduleFire();
 }
 
 bool AWeapon::ReadyToFire()
@@ -123,9 +137,35 @@ void AWeapon::ConsumeBufferedShot()
 	bHasBufferedShot = false;
 }
 
-void AWeapon::Tick(float DeltaTime)
+void AWeapon::RescheduleFire()
 {
-	Super::Tick(DeltaTime);
+	if (!IsPrimaryUsing && !HasBufferedShot())
+	{
+		return;
+	}
+
+	UWeaponFireScheduler* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UWeaponFireScheduler>() : nullptr;
+	if (!Scheduler)
+	{
+		return;
+	}
+
+	// A buffered shot that isn't backed by a held trigger must be woken up to expire, even if it can't fire yet.
+	float WakeTime = NextShotTime;
+	if (!IsPrimaryUsing)
+	{
+		WakeTime = FMath::Min(WakeTime, BufferedShotUntil);
+	}
+
+	Scheduler->ScheduleFire(this, WakeTime, ++FireScheduleGeneration);
+}
+
+void AWeapon::ProcessScheduledFire(uint32 Generation)
+{
+	if (Generation != FireScheduleGeneration)
+	{
+		return;
+	}
 
 	if ((IsPrimaryUsing || HasBufferedShot()) && ReadyToFire())
 	{
@@ -152,6 +192,8 @@ void AWeapon::Tick(float DeltaTime)
 			}
 		}
 	}
+
+	RescheduleFire();
 }
 
 void AWeapon::SetIsActive(bool bNewIsActive)
@@ -171,8 +213,8 @@ void AWeapon::RefreshComponentCache()
 	}
 	else
 	{
-		CachedMovementComponent = Cast<UGDKMovementComponent>(CachedOwner->GetComponentByClass(UGDKMovementComponent::StaticClass()));
-		CachedShootingComponent = Cast<UShootingComponent>(CachedOwner->GetComponentByClass(UShootingComponent::StaticClass()));
+		CachedMovementComponent = UGDKComponentRegistry::Find<UGDKMovementComponent>(CachedOwner);
+		CachedShootingComponent = UGDKComponentRegistry::Find<UShootingComponent>(CachedOwner);
 	}
 }
 
@@ -7,6 +7,20 @@
 #include "Engine.h"
 #include "BuildManagerComponent.generated.h"
 
+class ABuildableManager;
+
+// Where one wall segment should be placed, sent from the owning client in a single batch.
+USTRUCT()
+struct FBuildablePlacement
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	FRotator Rotation = FRotator::ZeroRotator;
+};
 
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
@@ -33,8 +47,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Building)
 		TSubclassOf<class ABuildable> BuildableFortification;
 
-	UFUNCTION(Server, reliable, WithValidation, BlueprintCallable)
-		void Server_PlaceBuildable(FVector const& Location, FRotator const& Rotation);
+	// Places every segment of a wall in one go.
+	UFUNCTION(Server, reliable, WithValidation)
+		void Server_PlaceBuildables(const TArray<FBuildablePlacement>& Placements);
+
+	// Segments beyond this in a single request are ignored.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Building)
+		int32 MaxSegmentsPerPlacement = 32;
+
+	// Wall segments are only snapped to the ground again once the end point has moved this far.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Building)
+		float SnapRefreshDistance = 25.f;
 
 protected:
 	// Called when the game starts
@@ -54,4 +77,35 @@ private:
 	ABuildable *currentBuildable;
 
 	TArray<ABuildable*> managedBuildables;
+
+	// Hidden, non-replicated previews waiting to be reused.
+	TArray<ABuildable*> previewPool;
+
+	ABuildable* AcquirePreview(const FVector& Location, const FRotator& Rotation);
+	void ReleasePreview(ABuildable* Preview);
+	void ReleaseAllPreviews();
+
+	// Starts async traces that snap every wall segment to the ground: one trace up to find a ceiling, then one down from it.
+	void RequestGroundSnap(const FVector& Direction, float SegmentLength);
+	void OnSnapUpTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 Generation);
+	void OnSnapDownTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 Generation);
+
+	FCollisionQueryParams MakeSnapTraceParams() const;
+
+	// Bumped whenever the wall changes, so results of older snap traces are ignored.
+	uint32 snapGeneration = 0;
+
+	// Whether each segment has its result for the latest snap generation, whether it found ground or not.
+	TArray<bool> snappedSegments;
+
+	// Set when the build is released while snap traces are still in flight. The wall is placed once they have all returned.
+	bool releasePending = false;
+	FVector lastSnapEnd;
+	int32 lastSnapSegments = 0;
+	float snapYaw = 0.f;
+
+	// [server] Found on first use rather than searched for on every placement.
+	ABuildableManager* GetBuildableManager();
+
+	TWeakObjectPtr<ABuildableManager> CachedBuildableManager;
 };
@@ -4,13 +4,15 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Runtime/AIModule/Classes/GenericTeamAgentInterface.h"
 #include "Characters/Components/HealthComponent.h"
+#include "Systems/ICrossServerDamageReceiver.h"
 #include "TestTag.h"
 #include "Buildable.generated.h"
 
 
 UCLASS()
-class GDKSHOOTER_API ABuildable : public AActor
+class GDKSHOOTER_API ABuildable : public AActor, public ICrossServerDamageReceiver
 {
 	GENERATED_BODY()
 	
@@ -37,11 +39,28 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Building)
 		class UTestTag* TestTag1;
 
-	UPROPERTY(ReplicatedUsing = OnRep_Collision)
-		TArray<bool> collision;
+	// Build stage (bits 0-1), placed flag (bit 2) and team (bits 4-7) in one replicated byte.
+	UPROPERTY(ReplicatedUsing = OnRep_PackedState)
+		uint8 PackedState;
 
 	UFUNCTION()
-	void OnRep_Collision();
+	void OnRep_PackedState();
+
+	// Teams above 14 do not fit in the packed state and are stored as NoTeam.
+	static uint8 PackState(uint8 Stage, bool bPlaced, FGenericTeamId Team);
+
+	static uint8 UnpackStage(uint8 State) { return State & StageMask; }
+	static FGenericTeamId UnpackTeam(uint8 State);
+
+	uint8 GetStage() const { return UnpackStage(PackedState); }
+	bool IsPlaced() const { return (PackedState & PlacedFlag) != 0; }
+
+	UFUNCTION(BlueprintPure, Category = Building)
+		FGenericTeamId GetBuildTeam() const;
+
+	// [server]
+	UFUNCTION(BlueprintCallable, Category = Building)
+		void SetBuildTeam(FGenericTeamId Team);
 
 	UFUNCTION(BlueprintCallable, Category = Building)
 		void Place();
@@ -58,12 +77,35 @@ public:
 
 	float TakeDamage(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	virtual void SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records) override;
+
 	UFUNCTION(CrossServer, Reliable)
-		void TakeDamageCrossServer(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
+		void TakeDamageCrossServer(const TArray<FCrossServerDamageRecord>& Records);
 	
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	// [server] Updates the build stage once the health component has resolved damage.
+	UFUNCTION()
+	void OnAuthoritativeHealthChanged(const AController* Instigator);
+
+	static constexpr uint8 StageMask = 0x03;
+	static constexpr uint8 PlacedFlag = 0x04;
+	static constexpr uint8 TeamShift = 4;
+	static constexpr uint8 NoTeamBits = 0x0F;
+
+	// [server] Replicates a new state and applies it locally.
+	void SetPackedState(uint8 NewState);
+
+	// Swaps the visible, colliding build mesh to match PackedState. Does nothing if it already matches.
+	void ApplyPackedState();
+
+	UStaticMeshComponent* GetBuildMesh(uint8 Stage) const;
+
+	// The build mesh that is currently visible and colliding, if any.
+	UPROPERTY(Transient)
+		UStaticMeshComponent* activeBuildMesh;
+
 };
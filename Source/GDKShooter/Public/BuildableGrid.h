@@ -0,0 +1,121 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid of placed buildables, used by the server to validate placement and to find pieces near a point
+ * without physics overlaps. Queries only visit the cells a radius can reach, so a query no wider than a cell touches 27 cells.
+ */
+struct FBuildableGrid
+{
+	struct FEntry
+	{
+		int32 Id;
+		FVector Location;
+	};
+
+	// Only takes effect while the grid is empty.
+	void SetCellSize(float InCellSize)
+	{
+		if (Cells.Num() == 0)
+		{
+			CellSize = FMath::Max(InCellSize, 1.0f);
+		}
+	}
+
+	void Add(int32 Id, const FVector& Location)
+	{
+		Cells.FindOrAdd(GetCell(Location)).Add(FEntry{ Id, Location });
+	}
+
+	void Remove(int32 Id, const FVector& Location)
+	{
+		const FIntVector Cell = GetCell(Location);
+		if (TArray<FEntry, TInlineAllocator<4>>* Entries = Cells.Find(Cell))
+		{
+			Entries->RemoveAllSwap([Id](const FEntry& Entry) { return Entry.Id == Id; });
+			if (Entries->Num() == 0)
+			{
+				Cells.Remove(Cell);
+			}
+		}
+	}
+
+	int32 CountInCell(const FVector& Location) const
+	{
+		const TArray<FEntry, TInlineAllocator<4>>* Entries = Cells.Find(GetCell(Location));
+		return Entries ? Entries->Num() : 0;
+	}
+
+	// Calls Visit(Entry, DistanceSquared) for every buildable within Radius of Location. Return false from Visit to stop early.
+	template<typename VisitorType>
+	void ForEachWithin(const FVector& Location, float Radius, VisitorType&& Visit) const
+	{
+		const float RadiusSq = FMath::Square(Radius);
+		const FIntVector Min = GetCell(Location - FVector(Radius));
+		const FIntVector Max = GetCell(Location + FVector(Radius));
+
+		for (int32 X = Min.X; X <= Max.X; X++)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+			{
+				for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+				{
+					const TArray<FEntry, TInlineAllocator<4>>* Entries = Cells.Find(FIntVector(X, Y, Z));
+					if (Entries == nullptr)
+					{
+						continue;
+					}
+
+					for (const FEntry& Entry : *Entries)
+					{
+						const float DistSq = FVector::DistSquared(Entry.Location, Location);
+						if (DistSq <= RadiusSq && !Visit(Entry, DistSq))
+						{
+							return;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	bool AnyWithin(const FVector& Location, float Radius) const
+	{
+		bool bFound = false;
+		ForEachWithin(Location, Radius, [&bFound](const FEntry&, float) { bFound = true; return false; });
+		return bFound;
+	}
+
+	// Id of the buildable closest to Location within Radius, or INDEX_NONE.
+	int32 FindClosest(const FVector& Location, float Radius) const
+	{
+		int32 ClosestId = INDEX_NONE;
+		float ClosestDistSq = MAX_flt;
+		ForEachWithin(Location, Radius, [&](const FEntry& Entry, float DistSq)
+		{
+			if (DistSq < ClosestDistSq)
+			{
+				ClosestDistSq = DistSq;
+				ClosestId = Entry.Id;
+			}
+			return true;
+		});
+		return ClosestId;
+	}
+
+private:
+	FIntVector GetCell(const FVector& Location) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(Location.X / CellSize),
+			FMath::FloorToInt(Location.Y / CellSize),
+			FMath::FloorToInt(Location.Z / CellSize));
+	}
+
+	float CellSize = 200.0f;
+
+	TMap<FIntVector, TArray<FEntry, TInlineAllocator<4>>> Cells;
+};
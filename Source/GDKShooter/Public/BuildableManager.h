@@ -4,27 +4,391 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
+#include "Runtime/AIModule/Classes/GenericTeamAgentInterface.h"
 #include "Buildable.h"
+#include "BuildableGrid.h"
+#include "BuildableSnapshot.h"
+#include "BuildableSupportGraph.h"
+#include "Systems/ICrossServerDamageReceiver.h"
 #include "BuildableManager.generated.h"
 
+struct Worker_EntityQueryResponseOp;
+
+class ABuildableManager;
+class UHierarchicalInstancedStaticMeshComponent;
+
+// One placed buildable, rendered as an instance of its type's mesh for its current stage.
+USTRUCT()
+struct FBuildableInstance : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	// Stable id, used to route damage and to find the instance's render slot.
+	UPROPERTY()
+	int32 Id = INDEX_NONE;
+
+	// Index into ABuildableManager::BuildableTypes.
+	UPROPERTY()
+	uint8 TypeIndex = 0;
+
+	// Stage and team in one byte, laid out as ABuildable::PackedState with the placed flag always set.
+	// The stage picks which of the buildable's build meshes is shown, 0 to ABuildableManager::NumStages - 1.
+	UPROPERTY()
+	uint8 PackedState = ABuildable::PackState(0, true, FGenericTeamId::NoTeam);
+
+	// Health as a fraction of the type's max health, in [0, 127].
+	UPROPERTY()
+	uint8 QuantizedHealth = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	// Exact health, only maintained on the server.
+	float Health = 0.0f;
+
+	uint8 GetStage() const { return ABuildable::UnpackStage(PackedState); }
+	FGenericTeamId GetTeam() const { return ABuildable::UnpackTeam(PackedState); }
+
+	void PreReplicatedRemove(const struct FBuildableInstanceArray& InArraySerializer);
+	void PostReplicatedAdd(const struct FBuildableInstanceArray& InArraySerializer);
+	void PostReplicatedChange(const struct FBuildableInstanceArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FBuildableInstanceArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FBuildableInstance> Items;
+
+	ABuildableManager* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FBuildableInstance, FBuildableInstanceArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FBuildableInstanceArray> : public TStructOpsTypeTraitsBase2<FBuildableInstanceArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+struct FBuildableInstanceHandle
+{
+	int32 ComponentIndex;
+	int32 InstanceIndex;
+};
+
+// One hierarchical instanced mesh component per buildable type and stage, and where each buildable's instance is in them.
+USTRUCT()
+struct FBuildableInstanceLayer
+{
+	GENERATED_BODY()
+
+	// At TypeIndex * ABuildableManager::NumStages + Stage.
+	UPROPERTY(Transient)
+	TArray<UHierarchicalInstancedStaticMeshComponent*> Components;
+
+	TMap<int32, FBuildableInstanceHandle> Handles;
+
+	// Buildable id of each instance in each component, mirroring the component's instance order.
+	TArray<TArray<int32>> InstanceIds;
+
+	// Id of the buildable at instance Item of Component, or INDEX_NONE if the component is not in this layer.
+	int32 FindId(const UPrimitiveComponent* Component, int32 Item) const;
+};
+
+/**
+ * Owns every placed buildable as a hierarchical instanced static mesh instance, one component per buildable type and stage.
+ * Per-instance health, stage and team live in a fast array that replicates only what changed,
+ * so a fortified map costs one actor and one channel instead of one replicated ABuildable per piece.
+ * ABuildable classes still describe each type (meshes and health) and are used for the placement preview.
+ */
 UCLASS()
-class GDKSHOOTER_API ABuildableManager : public AActor
+class GDKSHOOTER_API ABuildableManager : public AActor, public ICrossServerDamageReceiver
 {
 	GENERATED_BODY()
-	
-public:	
+
+public:
 	// Sets default values for this actor's properties
 	ABuildableManager();
-	// Called every frame
+
+	virtual void PostInitializeComponents() override;
+
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	UFUNCTION(BlueprintCallable)
 	void SpawnRequest(TSubclassOf<class ABuildable> BuildableFortification,FVector const& Location, FRotator const& Rotation);
 
+	// [server] False if the buildable's meshes would overlap another buildable's, or its grid cell is already full.
+	bool CanPlaceBuildable(TSubclassOf<ABuildable> BuildableType, const FVector& Location, const FRotator& Rotation) const;
+
+	// [server] Places a buildable and returns its id, or INDEX_NONE if it could not be placed.
+	int32 AddBuildable(TSubclassOf<ABuildable> BuildableType, const FVector& Location, const FRotator& Rotation, FGenericTeamId Team);
+
+	// [server]
+	bool RemoveBuildable(int32 Id);
+
+	// [server] Repairs the buildable with the given id, or the one closest to Location if the id is INDEX_NONE or not on Location.
+	void RepairAt(const FVector& Location, float Value, int32 Id = INDEX_NONE);
+
+	// Id of the buildable a trace on this machine hit, from the hit's render component and instance index.
+	// Hits that are not on a render component are assumed to carry an id already, e.g. from a client's trace, which FindHitInstance checks.
+	int32 GetHitBuildableId(const FHitResult& Hit) const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetNumBuildables() const { return Instances.Items.Num(); }
+
+	// [server] Ids of the buildables within Radius of Location.
+	void GetBuildablesNear(const FVector& Location, float Radius, TArray<int32>& OutIds) const;
+
+	// [server] Locations of the buildables within Radius of Location, e.g. for AI cover search.
+	UFUNCTION(BlueprintCallable, Category = Building)
+	TArray<FVector> GetBuildableLocationsNear(FVector Location, float Radius) const;
+
+	float TakeDamage(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
+
+	virtual void SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records) override;
+
+	UFUNCTION(CrossServer, Reliable)
+	void TakeDamageCrossServer(const TArray<FCrossServerDamageRecord>& Records);
+
+	// [server] Writes every placed buildable to a snapshot, e.g. to carry them over to the next session.
+	void ExportSnapshot(FBuildableSnapshot& OutSnapshot) const;
+
+	// [server] Queues a snapshot's buildables to be placed over the next frames, within ImportBudgetMs per frame.
+	void ImportSnapshot(const FBuildableSnapshot& Snapshot);
+
+	// [server] Saves every placed buildable to FBuildableSnapshot::GetSaveFilePath(), where the deployment snapshot template picks them up.
+	UFUNCTION(BlueprintCallable, Category = Building)
+	bool SaveBuildables() const;
+
+	// Render slot bookkeeping, called on every machine as instances are added, changed and removed.
+	// On clients, instances in far cells are kept out of the render components and drawn as their cell's proxy instead,
+	// while the collision components keep every instance.
+	void ShowInstance(const FBuildableInstance& Instance);
+	void HideInstance(int32 Id);
+
+	// Moves a shown instance to the render component for its stage. Only the stage is drawn, so other changes cost nothing.
+	void UpdateInstanceStage(const FBuildableInstance& Instance);
+
+	static constexpr int32 NumStages = 3;
+
 protected:
-	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION()
+	void OnRep_BuildableTypes();
+
+	// [server] Reads the buildables saved by the previous session: from the deployment's chunk entities with SpatialOS networking
+	// when UDeploymentSnapshotTemplate::bWriteSavedBuildables is set, else from the save file if bSaveOnEndPlay is set.
+	void LoadSavedBuildables();
+
+	void OnSnapshotQueryResponse(const Worker_EntityQueryResponseOp& Op);
+
+	// [server] Places queued imports until the frame's budget runs out.
+	void ImportPending();
+
+	// [server] Continues the support search and removes a few of the pieces it found unsupported.
+	void UpdateSupport();
+
+	bool HasPendingWork() const;
+
+	// [server] Whether there is level geometry, rather than another buildable, right below Location.
+	bool IsGrounded(const FVector& Location) const;
+
+	int32 GetOrAddTypeIndex(TSubclassOf<ABuildable> BuildableType);
+
+	float GetMaxHealth(uint8 TypeIndex) const;
+
+	// Same thresholds as ABuildable::HelathUpdate: health outside both bands keeps the current stage.
+	static uint8 GetStageForHealth(float Health, float MaxHealth, uint8 CurrentStage);
+
+	// [server] Adds an instance that has already passed placement checks.
+	int32 AddInstance(int32 TypeIndex, const FVector& Location, const FRotator& Rotation, FGenericTeamId Team, uint8 Stage, float Health);
+
+	// [server] Applies a health change to an item, updating its stage and removing it when it reaches zero.
+	void ModifyHealth(int32 ItemIndex, float Delta);
+
+	// [server] Index into Instances.Items of the buildable closest to Location, within DamageRouteRadius. O(1) through the grid.
+	// Used when the damage or repair does not carry the hit piece's id, or carries one that is not at the hit.
+	int32 FindInstanceNear(const FVector& Location) const;
+
+	// [server] Index into Instances.Items of the buildable that a hit at Location names by Id, or INDEX_NONE if it has been destroyed.
+	// Ids come from the shooting client's trace, so one is only trusted when Location is on that piece, otherwise the hit is routed by location.
+	int32 FindHitInstance(const FVector& Location, int32 Id) const;
+
+	// Build mesh of a type's stage in the buildable's default object, carrying its offset within the buildable. May be null.
+	const UStaticMeshComponent* GetStageMesh(uint8 TypeIndex, uint8 Stage) const;
+
+	// World space bounds of an instance's current stage mesh.
+	FBox GetInstanceBounds(const FBuildableInstance& Instance) const;
+
+	// Bounds of all of a type's build meshes relative to the buildable, less PlacementOverlapTolerance. Invalid if it has no meshes.
+	FBox GetPlacementBounds(TSubclassOf<ABuildable> BuildableType) const;
+
+	// [server] Whether an explosion at Origin is blocked before it reaches the piece, as URadialDamageSubsystem checks for actors.
+	bool IsExplosionOccluded(const FVector& Origin, int32 Id, const AActor* DamageCauser) const;
+
+	UHierarchicalInstancedStaticMeshComponent* GetLayerComponent(FBuildableInstanceLayer& Layer, uint8 TypeIndex, uint8 Stage, int32& OutComponentIndex);
+
+	// Adds or moves an instance in the layer's component for its type and stage.
+	void AddLayerInstance(FBuildableInstanceLayer& Layer, const FBuildableInstance& Instance);
+	void RemoveLayerInstance(FBuildableInstanceLayer& Layer, int32 Id);
+
+	// Far-field proxies are only used on clients, and only change what is drawn: pieces in far cells keep colliding through CollisionLayer.
+	bool UsesFarFieldProxies() const;
+
+	FIntVector GetProxyCellKey(const FVector& Location) const;
+
+	// [client] Switches cells between full instances and their proxy as the local view moves.
+	void UpdateFarField();
+
+	// Adds, resizes or removes a far cell's proxy instance to fit its pieces.
+	void UpdateProxyInstance(const FIntVector& CellKey);
+	void RemoveProxyInstance(const FIntVector& CellKey);
+
+	// Point damage that doesn't name the piece it hit goes to the closest buildable within this of the impact point.
+	// Radial damage that arrives with its falloff already applied hits every buildable within this of its origin.
+	UPROPERTY(EditAnywhere, Category = Building)
+	float DamageRouteRadius = 300.0f;
+
+	// Edge length of a placement grid cell.
+	UPROPERTY(EditDefaultsOnly, Category = Building)
+	float PlacementCellSize = 200.0f;
+
+	// Buildables closer than this to an existing one are rejected.
+	UPROPERTY(EditAnywhere, Category = Building)
+	float MinPlacementSpacing = 50.0f;
+
+	// Buildables whose meshes overlap an existing one's by more than this are rejected, so that pieces may touch.
+	UPROPERTY(EditAnywhere, Category = Building)
+	float PlacementOverlapTolerance = 10.0f;
+
+	// Explosions only damage pieces they can trace to on this channel, as with URadialDamageSubsystem's default DamagePreventionChannel.
+	UPROPERTY(EditAnywhere, Category = Building)
+	TEnumAsByte<ECollisionChannel> ExplosionOcclusionChannel = ECC_Visibility;
+
+	UPROPERTY(EditAnywhere, Category = Building)
+	int32 MaxBuildablesPerCell = 4;
+
+	// Milliseconds per frame spent placing imported buildables at server start.
+	UPROPERTY(EditAnywhere, Category = Building)
+	float ImportBudgetMs = 2.0f;
+
+	// Whether the server saves the placed buildables when it shuts down, and reads the save file back at the next start.
+	// Off by default, so that server and PIE sessions do not carry buildables over into each other.
+	UPROPERTY(EditAnywhere, Category = Building)
+	bool bSaveOnEndPlay = false;
+
+	// [server] Buildables waiting to be imported, and the classes their TypeIndex refers to.
+	FBuildableSnapshot PendingImport;
+	int32 NextPendingImport = 0;
+
+	UPROPERTY(Transient)
+	TArray<TSubclassOf<ABuildable>> PendingImportTypes;
+
+	// Buildables within this distance of each other hold each other up.
+	UPROPERTY(EditAnywhere, Category = Building)
+	float SupportRadius = 250.0f;
+
+	// A buildable is grounded if level geometry is within this distance below its origin.
+	UPROPERTY(EditAnywhere, Category = Building)
+	float GroundTraceDistance = 50.0f;
+
+	// Pieces the support search visits per frame.
+	UPROPERTY(EditAnywhere, Category = Building)
+	int32 SupportVisitsPerFrame = 256;
+
+	// Unsupported pieces removed per frame, so a large collapse is spread over several frames.
+	UPROPERTY(EditAnywhere, Category = Building)
+	int32 CollapsesPerFrame = 32;
+
+	// [server]
+	FBuildableSupportGraph SupportGraph;
+
+	// [server] Pieces found unsupported that have not been removed yet.
+	TArray<int32> PendingCollapses;
+
+	// Scratch buffer for support neighbours.
+	TArray<int32> SupportIds;
+
+	// Stand-in drawn for all the pieces in a far cell, scaled to their bounds. Expected to be 100 units across, like the engine cube.
+	UPROPERTY(EditDefaultsOnly, Category = "Building|Far Field")
+	UStaticMesh* ProxyMesh;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Building|Far Field")
+	float ProxyCellSize = 2000.0f;
+
+	// Cells further than this from the view are drawn as proxies. They switch back once 10% closer, so they do not flicker at the boundary.
+	UPROPERTY(EditAnywhere, Category = "Building|Far Field")
+	float FarFieldDistance = 10000.0f;
+
+	// Added around the piece origins of a cell to size its proxy.
+	UPROPERTY(EditDefaultsOnly, Category = "Building|Far Field")
+	FVector ProxyPadding = FVector(100.0f, 100.0f, 250.0f);
+
+	UPROPERTY(EditDefaultsOnly, Category = "Building|Far Field")
+	float FarFieldUpdateInterval = 0.5f;
+
+	UPROPERTY(Transient)
+	UHierarchicalInstancedStaticMeshComponent* ProxyComponent;
+
+	struct FProxyCell
+	{
+		// Copies of the cell's instances, so they can be shown again without searching the replicated array.
+		TArray<FBuildableInstance> Pieces;
+		bool bFar = false;
+		int32 ProxyInstanceIndex = INDEX_NONE;
+	};
+
+	// [client]
+	TMap<FIntVector, FProxyCell> ProxyCells;
+	TMap<int32, FIntVector> InstanceProxyCells;
+
+	// Cell of each proxy instance, mirroring ProxyComponent's instance order.
+	TArray<FIntVector> ProxyInstanceCells;
+
+	FTimerHandle FarFieldTimer;
+
+	// [server] Every placed buildable by location.
+	FBuildableGrid Grid;
+
+	// Scratch buffers for radial damage, the pieces hit and the damage each takes.
+	TArray<int32> SplashIds;
+	TArray<float> SplashDamage;
+
+	UPROPERTY(Replicated)
+	FBuildableInstanceArray Instances;
+
+	// Types that have been placed so far, referenced by FBuildableInstance::TypeIndex.
+	UPROPERTY(ReplicatedUsing = OnRep_BuildableTypes)
+	TArray<TSubclassOf<ABuildable>> BuildableTypes;
+
+	// Drawn instances. They also collide, unless far-field proxies are used.
+	UPROPERTY(Transient)
+	FBuildableInstanceLayer RenderLayer;
+
+	// [client] Hidden, colliding copies of every instance when far-field proxies are used. Never swapped for proxies,
+	// so far pieces still block the traces that clients decide their hits with.
+	UPROPERTY(Transient)
+	FBuildableInstanceLayer CollisionLayer;
 
-	TArray<ABuildable*> managedBuildables;
+	// [server] Id to index in Instances.Items.
+	TMap<int32, int32> InstanceIndices;
 
+	int32 NextInstanceId = 0;
 };
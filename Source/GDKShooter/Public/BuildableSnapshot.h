@@ -0,0 +1,61 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <WorkerSDK/improbable/c_worker.h>
+
+struct Schema_Object;
+
+// One placed buildable as saved between sessions. Serializes to 22 bytes.
+struct FBuildableSnapshotRecord
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	// Index into FBuildableSnapshot::Types.
+	uint8 TypeIndex = 0;
+	uint8 Stage = 0;
+	uint8 TeamId = 0;
+
+	// Health as a fraction of the type's max health, in [0, 127], as in FBuildableInstance.
+	uint8 QuantizedHealth = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FBuildableSnapshotRecord& Record);
+};
+
+/**
+ * Placed buildables in a compact, self-contained form: a type table followed by a packed array of records.
+ * The server saves one to disk when a session ends, the deployment snapshot template splits it into a few chunk entities,
+ * and ABuildableManager reads the chunks back when the deployment starts.
+ */
+struct GDKSHOOTER_API FBuildableSnapshot
+{
+	// Schema component holding one chunk, as a single bytes field.
+	static constexpr Worker_ComponentId ChunkComponentId = 1002;
+
+	// Records per chunk entity, keeping each component well under the Runtime's message size limit.
+	static constexpr int32 RecordsPerChunk = 2048;
+
+	// Class paths of the buildable types referenced by the records.
+	TArray<FString> Types;
+
+	TArray<FBuildableSnapshotRecord> Records;
+
+	void Serialize(FArchive& Ar);
+
+	// Saved/Buildables/Buildables.bin
+	static FString GetSaveFilePath();
+
+	bool SaveToFile() const;
+	bool LoadFromFile();
+
+	// Splits the records into chunks of at most RecordsPerChunk, each carrying a copy of the type table.
+	void SplitIntoChunks(TArray<FBuildableSnapshot>& OutChunks) const;
+
+	// Appends another snapshot's records, remapping their type indices.
+	void Append(const FBuildableSnapshot& Other);
+
+	void WriteChunkComponent(Schema_Object* ComponentFields) const;
+	bool ReadChunkComponent(Schema_Object* ComponentFields);
+};
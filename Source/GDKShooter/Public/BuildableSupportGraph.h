@@ -0,0 +1,48 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Which placed buildables hold each other up. A piece stands as long as a chain of neighbours connects it to a grounded piece.
+ * Adding and removing a piece only touches its neighbours; removal marks them as suspects, and Update searches from each suspect
+ * for ground within a per-call budget, so a large base losing one pillar is checked over several frames instead of in one.
+ */
+struct GDKSHOOTER_API FBuildableSupportGraph
+{
+	void Add(int32 Id, bool bGrounded, TArrayView<const int32> Neighbours);
+
+	// Neighbours that are not grounded themselves become suspects.
+	void Remove(int32 Id);
+
+	bool HasWork() const { return Suspects.Num() > 0 || bSearching; }
+
+	// Visits at most MaxVisits pieces. Pieces found to have no path to the ground are removed from the graph and added to OutUnsupported.
+	void Update(int32 MaxVisits, TArray<int32>& OutUnsupported);
+
+	void Reset();
+
+	int32 Num() const { return Nodes.Num(); }
+
+private:
+	struct FNode
+	{
+		bool bGrounded = false;
+		TArray<int32, TInlineAllocator<6>> Neighbours;
+	};
+
+	void StartSearch(int32 Root);
+	void EndSearch();
+
+	TMap<int32, FNode> Nodes;
+
+	// Pieces that lost a neighbour and may have lost their last path to the ground.
+	TArray<int32> Suspects;
+
+	// The search in progress, a flood fill from SearchRoot that stops at the first grounded piece.
+	bool bSearching = false;
+	int32 SearchRoot = INDEX_NONE;
+	TSet<int32> SearchVisited;
+	TArray<int32> SearchFrontier;
+};
@@ -20,6 +20,9 @@ public:
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	friend class FSavedMove_GDKMovement;
 
 	UGDKMovementComponent(const FObjectInitializer& ObjectInitializer);
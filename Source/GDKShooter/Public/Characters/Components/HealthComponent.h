@@ -10,6 +10,31 @@
 #include "TimerManager.h"
 #include "HealthComponent.generated.h"
 
+struct FDamageRecord;
+struct FRegenerationRates;
+
+// One instance of damage taken, sent to the victim's owning client.
+USTRUCT()
+struct FDamageFeedback
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	float Value = 0.0f;
+
+	UPROPERTY()
+	FVector_NetQuantize Source;
+
+	UPROPERTY()
+	FVector_NetQuantize Impact;
+
+	UPROPERTY()
+	int32 InstigatorPlayerId = -1;
+
+	UPROPERTY()
+	FGenericTeamId InstigatorTeamId;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFloatValue, float, Current, float, Max);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FDamageTakenEvent, float, Value, FVector, Source, FVector, Impact, int32, InstigatorPlayerId, FGenericTeamId, InstigatorTeamId);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDeathCauserEvent, const AController*, Instigator);
@@ -24,6 +49,9 @@ class GDKSHOOTER_API UHealthComponent : public UActorComponent
 public:	
 	UHealthComponent();
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	virtual void BeginPlay() override;
 
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
@@ -33,6 +61,15 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual void TakeDamage(float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
 
+	// [server] Applies a frame's worth of damage records, in order. Returns the index of the record that killed the owner, or INDEX_NONE.
+	int32 ResolveDamage(TArrayView<const FDamageRecord> Records);
+
+	// [server] Announces death to listeners and to the victim's and killer's controllers.
+	void HandleDeath(AController* EventInstigator);
+
+	// [server] Called by URegenerationSubsystem with the amounts that have come due. Does nothing once dead.
+	void Regenerate(float HealthValue, float ArmourValue);
+
 	UFUNCTION(BlueprintCallable)
 	bool GrantShield(float Value);
 
@@ -82,9 +119,29 @@ public:
 	FDeathEvent Death;
 
 protected:
-	// Notifies all clients that a the character has been hit and from what direction.
+	// [server] Sends the feedback ResolveDamage queued for the owning client and spectators, once per frame.
+	void FlushDamageFeedback();
+
+	static void GetInstigatorIds(AController* EventInstigator, AActor* DamageCauser, int32& OutPlayerId, FGenericTeamId& OutTeamId);
+
+	// Notifies the owning client of every hit it took this frame, and from what direction.
+	UFUNCTION(Client, Unreliable)
+	void ClientDamageTaken(const TArray<FDamageFeedback>& Feedback);
+
+	// Coarse damage notification for everyone else, at most once per SpectatorDamageInterval,
+	// or every frame with damage for victims without an owning client, such as target dummies.
 	UFUNCTION(NetMulticast, Unreliable)
-	void MulticastDamageTaken(float Value, FVector Source, FVector Impact, int32 InstigatorPlayerId, FGenericTeamId InstigatorTeamId);
+	void MulticastCoarseDamageTaken(float Value, FVector_NetQuantize Source, FVector_NetQuantize Impact);
+
+	// Minimum time between coarse damage multicasts to non-owning clients. 0 disables them for victims with an owning client.
+	UPROPERTY(EditAnywhere, Category = "Health")
+	float SpectatorDamageInterval = 0.25f;
+
+	TArray<FDamageFeedback> PendingDamageFeedback;
+
+	// Damage accumulated since the last coarse multicast.
+	float PendingSpectatorDamage = 0.0f;
+	float LastSpectatorDamageTime = 0.0f;
 
 	UFUNCTION()
 	void OnRep_CurrentHealth();
@@ -92,14 +149,32 @@ protected:
 	UFUNCTION()
 	void OnRep_CurrentArmour();
 
+	UFUNCTION()
+	void OnRep_QuantizedHealth();
+
+	UFUNCTION()
+	void OnRep_QuantizedArmour();
+
+	static constexpr uint8 QuantizedMax = 127;
+
+	static uint8 Quantize(float Value, float Max);
+	static float Dequantize(uint8 Value, float Max);
+
+	// [server] Refreshes the quantized values from the exact ones, call after changing health or armour.
+	void UpdateQuantizedValues();
+
 	// Max health this character can have.
 	UPROPERTY(EditDefaultsOnly, Category = "Health", meta = (ClampMin = "1"))
 	float MaxHealth;
 
-	// Current health of the character, can be at most MaxHealth.
+	// Current health of the character, can be at most MaxHealth. Exact for the server and owning client only.
 	UPROPERTY(VisibleAnywhere, ReplicatedUsing = OnRep_CurrentHealth, Category = "Health")
 	float CurrentHealth;
 
+	// CurrentHealth as a fraction of MaxHealth in [0, QuantizedMax], replicated to everyone but the owner.
+	UPROPERTY(ReplicatedUsing = OnRep_QuantizedHealth)
+	uint8 QuantizedHealth;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Health")
 		float startHealth;
 
@@ -107,14 +182,15 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Health", meta = (ClampMin = "1"))
 	float MaxArmour;
 
-	// Current armour of the character, can be at most MaxArmour.
+	// Current armour of the character, can be at most MaxArmour. Exact for the server and owning client only.
 	UPROPERTY(VisibleAnywhere, ReplicatedUsing = OnRep_CurrentArmour, Category = "Health")
 	float CurrentArmour;
 
-	FTimerHandle HealthRegenerationHandle;
+	// CurrentArmour as a fraction of MaxArmour in [0, QuantizedMax], replicated to everyone but the owner.
+	UPROPERTY(ReplicatedUsing = OnRep_QuantizedArmour)
+	uint8 QuantizedArmour;
 
-	UFUNCTION()
-	void RegenerateHealth();
+	FRegenerationRates GetRegenerationRates() const;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float HealthRegenValue;
@@ -125,11 +201,6 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float HealthRegenInterval;
 
-	FTimerHandle ArmourRegenerationHandle;
-
-	UFUNCTION()
-	void RegenerateArmour();
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float ArmourRegenValue;
 
@@ -27,6 +27,9 @@ class GDKSHOOTER_API UMetaDataComponent : public UActorComponent
 public:	
 	UMetaDataComponent();
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	FORCEINLINE FGDKMetaData GetMetaData() const
@@ -3,7 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
 #include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "Weapons/HitboxCollision.h"
 #include "Weapons/ITraceProvider.h"
 #include "ShootingComponent.generated.h"
 
@@ -25,13 +28,22 @@ struct FInstantHitInfo
 	UPROPERTY(BlueprintReadOnly)
 	bool bDidHit;
 
+	// Piece hit within HitActor, for actors made of many instances such as ABuildableManager, or INDEX_NONE.
+	// Resolved by the shooter, as instance indices differ between machines.
+	UPROPERTY()
+	int32 HitItem;
+
 	FInstantHitInfo() :
 		Location(FVector{ 0,0,0 }),
 		HitActor(nullptr),
-		bDidHit(false)
+		bDidHit(false),
+		HitItem(INDEX_NONE)
 	{}
 };
 
+// Results of a batch of line traces, in the same order as the requested directions.
+DECLARE_DELEGATE_OneParam(FInstantHitBatchDelegate, const TArray<FInstantHitInfo>&);
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class GDKSHOOTER_API UShootingComponent : public UActorComponent
 {
@@ -41,6 +53,9 @@ public:
 	// Sets default values for this component's properties
 	UShootingComponent();
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	void BeginPlay();
 
 	UPROPERTY(BlueprintAssignable)
@@ -64,6 +79,13 @@ public:
 
 	UFUNCTION(BlueprintPure)
 	FInstantHitInfo DoLineTrace(FVector Direction, AActor* ActorToIgnore = nullptr);
+
+	// Traces one ray per direction from the trace start, e.g. for pellet or burst weapons.
+	// Rays are submitted through the engine's async trace interface and OnComplete fires next frame with all results.
+	// With bSynchronous the rays are traced immediately and OnComplete fires before returning; used on the server's authoritative path.
+	void DoLineTraceBatch(const TArray<FVector>& Directions, AActor* ActorToIgnore, const FInstantHitBatchDelegate& OnComplete, bool bSynchronous = false);
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Shooting")
@@ -73,7 +95,28 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Shooting")
 	float MaxRange;
 	
-	// Channel to use for raytrace on shot
+	// Channel to use for raytrace on shot. Pawns and vehicles are hit through their hitbox proxies on this channel.
+	UPROPERTY(EditAnywhere, Category = "Shooting")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_WeaponTrace;
+
+	// Trace against complex (per-poly) collision. Hitboxes are simple shapes, so this is only needed for precise world impacts.
 	UPROPERTY(EditAnywhere, Category = "Shooting")
-	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_WorldStatic;
+	bool bTraceComplex = false;
+
+private:
+	struct FPendingTraceBatch
+	{
+		TArray<FInstantHitInfo> Results;
+		int32 Remaining;
+		FInstantHitBatchDelegate OnComplete;
+	};
+
+	FCollisionQueryParams MakeTraceParams(AActor* ActorToIgnore) const;
+
+	static FInstantHitInfo MakeHitInfo(bool bDidHit, const FHitResult& HitResult, const FVector& TraceEnd);
+
+	void OnBatchTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum, uint32 BatchId);
+
+	TMap<uint32, FPendingTraceBatch> PendingTraceBatches;
+	uint32 NextTraceBatchId = 0;
 };
@@ -31,6 +31,9 @@ class GDKSHOOTER_API UTeamComponent : public UActorComponent
 public:	
 	UTeamComponent();
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	UPROPERTY(BlueprintAssignable)
 	FTeamChangedEvent TeamChanged;
 
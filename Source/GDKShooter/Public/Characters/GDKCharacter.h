@@ -11,6 +11,7 @@
 #include "Characters/Components/GDKMovementComponent.h"
 #include "Characters/Components/TeamComponent.h"
 #include "Weapons/Holdable.h"
+#include "Systems/ICrossServerDamageReceiver.h"
 #include "../TagComponent.h"
 #include "../TagComponent_BlueTeam.h"
 #include "../TagComponent_RedTeam.h"
@@ -23,7 +24,7 @@ DECLARE_DELEGATE_OneParam(FBoolean, bool);
 DECLARE_DELEGATE_OneParam(FHoldableSelection, int32);
 
 UCLASS()
-class GDKSHOOTER_API AGDKCharacter : public ACharacter, public IGenericTeamAgentInterface, public IAISightTargetInterface
+class GDKSHOOTER_API AGDKCharacter : public ACharacter, public IGenericTeamAgentInterface, public IAISightTargetInterface, public ICrossServerDamageReceiver
 {
 	GENERATED_BODY()
 
@@ -53,6 +54,17 @@ protected:
 	UPROPERTY(Category = Character, VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 		class UBuildManagerComponent* BuildManager;
 
+	// Simplified hit proxy used by weapon traces instead of the capsule and skeletal mesh.
+	UPROPERTY(Category = Character, VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UCapsuleComponent* Hitbox;
+
+	// How much shorter the hitbox is than the movement capsule, standing or crouched.
+	UPROPERTY(EditDefaultsOnly, Category = Character)
+	float HitboxHeightInset = 4.0f;
+
+	virtual void OnStartCrouch(float HalfHeightAdjust, float ScaledHalfHeightAdjust) override;
+	virtual void OnEndCrouch(float HalfHeightAdjust, float ScaledHalfHeightAdjust) override;
+
 	UFUNCTION(BlueprintPure)
 	float GetRemotePitch() {
 		return RemoteViewPitch;
@@ -96,8 +108,10 @@ private:
 public:
 	float TakeDamage(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	virtual void SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records) override;
+
 	UFUNCTION(CrossServer, Reliable)
-	void TakeDamageCrossServer(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
+	void TakeDamageCrossServer(const TArray<FCrossServerDamageRecord>& Records);
 
 	//UFUNCTION(BlueprintCallable)
 	void AttachProtoTeamComponent(FGenericTeamId teamInt);
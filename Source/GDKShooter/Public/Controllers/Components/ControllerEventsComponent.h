@@ -7,8 +7,25 @@
 #include "GameFramework/Actor.h"
 #include "ControllerEventsComponent.generated.h"
 
+// Damage this controller's pawn dealt to a victim, sent to the instigating client for hit markers.
+USTRUCT(BlueprintType)
+struct FDamageDealtFeedback
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	AActor* Victim = nullptr;
+
+	UPROPERTY(BlueprintReadOnly)
+	float Value = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	FVector_NetQuantize Impact;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FControllerEvent, const AController*, Controller);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FKillDetailsEvent, const FString&, VictimName, int32, VictimId);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDamageDealtEvent, const FDamageDealtFeedback&, Feedback);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class GDKSHOOTER_API UControllerEventsComponent : public UActorComponent
@@ -18,6 +35,9 @@ class GDKSHOOTER_API UControllerEventsComponent : public UActorComponent
 public:	
 	UControllerEventsComponent();
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	UFUNCTION(CrossServer, Reliable)
 	void Death(const AController* Killer);
 
@@ -41,4 +61,23 @@ public:
 
 	UPROPERTY(BlueprintAssignable)
 	FKillDetailsEvent DeathDetailsEvent;
+
+	// [server] Queues hit feedback for this controller's client, sent once per frame.
+	void QueueDamageDealt(const FDamageDealtFeedback& Feedback);
+
+	// [client] Fired once per damage instance dealt by this controller's pawn.
+	UPROPERTY(BlueprintAssignable)
+	FDamageDealtEvent DamageDealtEvent;
+
+private:
+	// Forwards feedback queued on a worker without authority over this controller.
+	UFUNCTION(CrossServer, Unreliable)
+	void DamageDealt(const TArray<FDamageDealtFeedback>& Feedback);
+
+	UFUNCTION(Client, Unreliable)
+	void ClientDamageDealt(const TArray<FDamageDealtFeedback>& Feedback);
+
+	void FlushDamageDealt();
+
+	TArray<FDamageDealtFeedback> PendingDamageDealt;
 };
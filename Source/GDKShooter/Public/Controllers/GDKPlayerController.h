@@ -14,6 +14,7 @@
 #include "Game/Components/MatchStateComponent.h"
 #include "SpatialGDK\Public\EngineClasses\Components\ActorInterestComponent.h"
 #include "Characters/GDKCharacter.h"
+#include "Controllers/ViewConeConstraint.h"
 #include "GDKPlayerController.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPawnEvent, APawn*, InPawn);
@@ -44,6 +45,12 @@ public:
 	// which handles user input.
 	bool IgnoreActionInput() const { return bIgnoreActionInput; }
 
+	// The view cones used for interest, nearest range first.
+	void GetViewConeConstraints(TArray<const UViewConeConstraint*>& OutConstraints) const;
+
+	// Where view points are written while GDK.RecordInterestPaths is set, for UInterestEvaluationCommandlet.
+	static FString GetInterestPathsFile();
+
 protected:
 	UPROPERTY(BlueprintAssignable)
 	FPawnEvent PawnEvent;
@@ -79,7 +86,13 @@ protected:
 		UAndConstraint* FOVConstraint1;
 
 	UPROPERTY(VisibleAnywhere)
-		USphereConstraint* Sphere1;
+		UViewConeConstraint* ViewConeNear;
+
+	UPROPERTY(VisibleAnywhere)
+		UAndConstraint* FOVConstraint2;
+
+	UPROPERTY(VisibleAnywhere)
+		UViewConeConstraint* ViewConeFar;
 
 	UPROPERTY(VisibleAnywhere)
 		URelativeSphereConstraint* RelativeSphere;
@@ -89,12 +102,32 @@ protected:
 		UActorClassConstraint* Actor1;
 
 
+	// [server] Sends the interest queries now, whether or not they changed.
 	UFUNCTION(BlueprintCallable)
 		void QueryTest();
 
-	virtual void SetControlRotation(const FRotator& NewRotation) override;
+	// [server] Sends the interest queries if the view has moved or turned past a threshold, or the team changed, since they were last sent.
+	// The constraints hold the values last sent, so they double as the previous query set to diff against.
+	void UpdateInterest(bool bForce);
+
+	// The view must move this far from where it was last sent before the queries are resent.
+	UPROPERTY(EditDefaultsOnly, Category = Interest)
+		float InterestMoveThreshold = 500.0f;
+
+	// The view must turn this many degrees from where it last pointed before the queries are resent.
+	UPROPERTY(EditDefaultsOnly, Category = Interest)
+		float InterestAngleThreshold = 15.0f;
+
+	// Minimum real time between two interest updates, in seconds.
+	UPROPERTY(EditDefaultsOnly, Category = Interest)
+		float InterestMinInterval = 0.25f;
+
+	double LastInterestUpdateTime = 0.0;
+
+	// [server] Appends the current view point to GetInterestPathsFile(), at most twice a second.
+	void RecordInterestPath();
 
-	int32 updateCounter;
+	double LastInterestPathTime = -1.0;
 
 private:
 	// Requests to spawn player pawn and join play
@@ -0,0 +1,24 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "InterestEvaluationCommandlet.generated.h"
+
+/**
+ * Replays view points recorded with GDK.RecordInterestPaths and compares, for every pair of players sampled at the same time,
+ * what the old forward sphere and the view cone queries would have pulled in against what was actually inside the view cone.
+ *
+ * UE4Editor-Cmd.exe GDKShooter.uproject -run=InterestEvaluation [-Paths=<csv>] [-Controller=<controller class path>]
+ */
+UCLASS()
+class GDKSHOOTER_API UInterestEvaluationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UInterestEvaluationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
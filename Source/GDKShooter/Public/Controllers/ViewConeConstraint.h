@@ -0,0 +1,48 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EngineClasses/Components/ActorInterestQueryConstraints.h"
+#include "ViewConeConstraint.generated.h"
+
+/**
+ * Interest in the entities inside a view cone, between MinRange and MaxRange from its apex.
+ * Query constraints have no cone shape, so the cone is sent as NumSpheres spheres along its axis that together cover it.
+ * Only the apex and direction change at runtime, and the update carries NumSpheres centers and radii.
+ */
+UCLASS()
+class GDKSHOOTER_API UViewConeConstraint : public UAbstractQueryConstraint
+{
+	GENERATED_BODY()
+
+public:
+	virtual void CreateConstraint(const USchemaDatabase& SchemaDatabase, SpatialGDK::QueryConstraint& OutConstraint) const override;
+
+	// The spheres sent for a cone at Apex looking along Direction. Each covers one segment of the cone's axis, segments grow with range.
+	// No sphere reaches behind the apex, whatever the half angle.
+	void GetCoveringSpheres(const FVector& InApex, const FVector& InDirection, TArray<FSphere>& OutSpheres) const;
+
+	// Whether Point is inside the cone itself, rather than the spheres covering it.
+	bool IsInCone(const FVector& InApex, const FVector& InDirection, const FVector& Point) const;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "View Cone Constraint")
+	FVector Apex = FVector::ZeroVector;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "View Cone Constraint")
+	FVector Direction = FVector::ForwardVector;
+
+	// In degrees.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "View Cone Constraint")
+	float HalfAngle = 45.0f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "View Cone Constraint")
+	float MinRange = 500.0f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "View Cone Constraint")
+	float MaxRange = 6000.0f;
+
+	// More spheres fit the cone more tightly, at the cost of a larger interest update.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "View Cone Constraint")
+	int32 NumSpheres = 3;
+};
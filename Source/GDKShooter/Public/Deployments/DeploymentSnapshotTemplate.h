@@ -9,11 +9,23 @@
 #include "DeploymentSnapshotTemplate.generated.h"
 
 
-UCLASS()
+UCLASS(config = Game)
 class GDKSHOOTER_API UDeploymentSnapshotTemplate : public USnapshotGenerationTemplate
 {
 	GENERATED_BODY()
 
 public:
 	bool WriteToSnapshotOutput(Worker_SnapshotOutputStream* OutputStream, Worker_EntityId& NextEntityId) override;	
+
+	// Whether saved buildables are written to the snapshot as chunk entities, and read back from them by ABuildableManager.
+	// Requires a schema component with id FBuildableSnapshot::ChunkComponentId holding one bytes field, which this project
+	// does not define yet: the Runtime does not load a snapshot containing components it has no schema for.
+	UPROPERTY(Config, EditAnywhere, Category = Buildables)
+	bool bWriteSavedBuildables = false;
+
+private:
+	bool WriteSessionEntity(Worker_SnapshotOutputStream* OutputStream, Worker_EntityId& NextEntityId);
+
+	// Writes the buildables saved by the last session as a few chunk entities, see FBuildableSnapshot.
+	bool WriteBuildableEntities(Worker_SnapshotOutputStream* OutputStream, Worker_EntityId& NextEntityId);
 };
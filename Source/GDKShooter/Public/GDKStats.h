@@ -0,0 +1,9 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Stat group for GDKShooter gameplay systems. View in game with "stat GDKShooter".
+DECLARE_STATS_GROUP(TEXT("GDKShooter"), STATGROUP_GDKShooter, STATCAT_Advanced);
@@ -24,6 +24,9 @@ class GDKSHOOTER_API UPlayerPublisher : public UActorComponent
 	GENERATED_BODY()
 
 public:
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	UFUNCTION(BlueprintCallable)
 	void PublishPlayer(APlayerState* PlayerState, EPlayerProgress Progress) { PlayerEvent.Broadcast(PlayerState, Progress); }
 
@@ -4,12 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "Systems/ICrossServerDamageReceiver.h"
 #include "CrossServerPawn.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FIncomingDamageEvent, float, Damage, const struct FDamageEvent&, DamageEvent, AController*, EventInstigator, AActor*, DamageCauser);
 
 UCLASS()
-class GDKSHOOTER_API ACrossServerPawn : public APawn
+class GDKSHOOTER_API ACrossServerPawn : public APawn, public ICrossServerDamageReceiver
 {
 	GENERATED_BODY()
 
@@ -19,6 +20,8 @@ public:
 
 	float TakeDamage(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	virtual void SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records) override;
+
 	UFUNCTION(CrossServer, Reliable)
-	void TakeDamageCrossServer(float Damage, const struct FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
+	void TakeDamageCrossServer(const TArray<FCrossServerDamageRecord>& Records);
 };
@@ -0,0 +1,83 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Systems/ICrossServerDamageReceiver.h"
+#include "Tickable.h"
+#include "DamageSubsystem.generated.h"
+
+class AController;
+class UHealthComponent;
+
+// One call to UHealthComponent::TakeDamage, waiting to be resolved at the end of the frame.
+struct FDamageRecord
+{
+	// Global order in which damage was received, used to keep death ordering stable.
+	uint64 Sequence = 0;
+
+	TWeakObjectPtr<UHealthComponent> Victim;
+	TWeakObjectPtr<AController> Instigator;
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	float Damage = 0.0f;
+	FVector Source = FVector::ZeroVector;
+	FVector Impact = FVector::ZeroVector;
+};
+
+/**
+ * Buffers damage received during a frame and resolves it once per victim at the end of the frame,
+ * so the health, death, regeneration and replication logic of a victim runs once however many times it was hit.
+ * Deaths are announced in the order the killing hits were received.
+ *
+ * Damage dealt to actors owned by another worker is coalesced the same way, into one cross-server RPC per victim per frame.
+ */
+UCLASS()
+class GDKSHOOTER_API UDamageSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+	// [server] Queues damage for resolution at the end of this frame.
+	void QueueDamage(FDamageRecord&& Record);
+
+	// [server] Resolves everything queued so far.
+	void ResolvePendingDamage();
+
+	// Queues damage for Victim's authoritative worker, or sends it straight away if the subsystem is unavailable.
+	static void DealCrossServerDamage(AActor* Victim, float Damage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
+
+	// [server] Queues damage to be sent to the victim's authoritative worker at the end of this frame.
+	void QueueCrossServerDamage(AActor* Victim, const FCrossServerDamageRecord& Record);
+
+	// [server] Sends one RPC per victim carrying everything queued for it so far.
+	void FlushCrossServerDamage();
+
+private:
+	struct FPendingCrossServerDamage
+	{
+		TWeakObjectPtr<AActor> Victim;
+		TArray<FCrossServerDamageRecord> Records;
+	};
+
+	// In order of each victim's first hit, so RPCs are sent in roughly the order damage was dealt.
+	TArray<FPendingCrossServerDamage> PendingCrossServerDamage;
+	TMap<AActor*, int32> PendingCrossServerIndices;
+
+	TArray<FDamageRecord> PendingRecords;
+
+	// Records being resolved, kept to reuse the allocation.
+	TArray<FDamageRecord> ResolvingRecords;
+
+	uint64 NextSequence = 0;
+};
@@ -0,0 +1,90 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GDKComponentRegistry.generated.h"
+
+class AActor;
+class UActorComponent;
+
+// Gameplay components that can be looked up through UGDKComponentRegistry.
+enum class EGDKComponentSlot : uint8
+{
+	Health,
+	Team,
+	MetaData,
+	ControllerEvents,
+	PlayerPublisher,
+	Shooting,
+	Movement,
+	Count
+};
+
+template<typename T>
+struct TGDKComponentSlot;
+
+#define GDK_REGISTERED_COMPONENT(ComponentType, SlotName) \
+	class ComponentType; \
+	template<> struct TGDKComponentSlot<ComponentType> { static constexpr EGDKComponentSlot Slot = EGDKComponentSlot::SlotName; };
+
+GDK_REGISTERED_COMPONENT(UHealthComponent, Health)
+GDK_REGISTERED_COMPONENT(UTeamComponent, Team)
+GDK_REGISTERED_COMPONENT(UMetaDataComponent, MetaData)
+GDK_REGISTERED_COMPONENT(UControllerEventsComponent, ControllerEvents)
+GDK_REGISTERED_COMPONENT(UPlayerPublisher, PlayerPublisher)
+GDK_REGISTERED_COMPONENT(UShootingComponent, Shooting)
+GDK_REGISTERED_COMPONENT(UGDKMovementComponent, Movement)
+
+/**
+ * Typed lookup of the project's gameplay components by owning actor, replacing GetComponentByClass on hot paths.
+ * Components add themselves in OnRegister and remove themselves in OnUnregister, so a lookup is one hash
+ * instead of a scan over every component the actor owns. If an actor has several components of a type, the first registered wins
+ * and the next one takes over when it is unregistered.
+ * Each world keeps its own registry of weak pointers, and lookups that miss fall back to scanning the actor's components.
+ */
+UCLASS()
+class GDKSHOOTER_API UGDKComponentRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	template<typename T>
+	static void Register(T* Component)
+	{
+		RegisterSlot(Component, TGDKComponentSlot<T>::Slot);
+	}
+
+	template<typename T>
+	static void Unregister(T* Component)
+	{
+		UnregisterSlot(Component, TGDKComponentSlot<T>::Slot, T::StaticClass());
+	}
+
+	template<typename T>
+	static T* Find(const AActor* Actor)
+	{
+		return static_cast<T*>(FindSlot(Actor, TGDKComponentSlot<T>::Slot, T::StaticClass()));
+	}
+
+private:
+	static UGDKComponentRegistry* Get(const UObject* WorldContextObject);
+
+	static void RegisterSlot(UActorComponent* Component, EGDKComponentSlot Slot);
+	static void UnregisterSlot(UActorComponent* Component, EGDKComponentSlot Slot, UClass* SlotClass);
+	static UActorComponent* FindSlot(const AActor* Actor, EGDKComponentSlot Slot, UClass* SlotClass);
+
+	// First registered component of SlotClass on Actor other than Excluded, by scanning its components.
+	static UActorComponent* FindRegisteredComponent(const AActor* Actor, UClass* SlotClass, const UActorComponent* Excluded = nullptr);
+
+	struct FSlots
+	{
+		TWeakObjectPtr<UActorComponent> Components[(int32)EGDKComponentSlot::Count];
+	};
+
+	TMap<TObjectKey<AActor>, FSlots> ActorSlots;
+};
@@ -0,0 +1,78 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "GameFramework/DamageType.h"
+#include "UObject/Interface.h"
+
+#include "ICrossServerDamageReceiver.generated.h"
+
+UENUM()
+enum class ECrossServerDamageKind : uint8
+{
+	Generic,
+	Point,
+	Radial
+};
+
+// Compact form of one TakeDamage call, sent to the worker authoritative over the victim.
+USTRUCT()
+struct GDKSHOOTER_API FCrossServerDamageRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	float Damage = 0.0f;
+
+	UPROPERTY()
+	ECrossServerDamageKind Kind = ECrossServerDamageKind::Generic;
+
+	UPROPERTY()
+	TSubclassOf<UDamageType> DamageTypeClass;
+
+	// Impact point of point damage, or origin of radial damage.
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal ShotDirection;
+
+	// FHitResult::Item of point damage, e.g. which buildable ABuildableManager was hit.
+	UPROPERTY()
+	int32 Item = INDEX_NONE;
+
+	// Radial damage without component hits keeps its falloff here for the receiver to apply per piece, and Damage stays the base damage.
+	// OuterRadius is 0 when the falloff has already been applied.
+	UPROPERTY()
+	FRadialDamageParams RadialParams;
+
+	UPROPERTY()
+	AController* Instigator = nullptr;
+
+	UPROPERTY()
+	AActor* DamageCauser = nullptr;
+
+	// Radial falloff is resolved here, so the receiver only needs the final damage and the origin.
+	static FCrossServerDamageRecord Make(float InDamage, const FDamageEvent& DamageEvent, AController* EventInstigator, AActor* InDamageCauser);
+
+	// Rebuilds the damage event and passes it to Apply.
+	void Unpack(TFunctionRef<void(float, const FDamageEvent&, AController*, AActor*)> Apply) const;
+};
+
+UINTERFACE(meta = (CannotImplementInterfaceInBlueprint))
+class GDKSHOOTER_API UCrossServerDamageReceiver : public UInterface
+{
+	GENERATED_BODY()
+};
+
+// Actors whose damage is applied by the worker authoritative over them, batched by UDamageSubsystem.
+class GDKSHOOTER_API ICrossServerDamageReceiver
+{
+	GENERATED_BODY()
+
+public:
+	// Sends one frame's worth of damage for this actor, in the order it was dealt.
+	virtual void SendCrossServerDamage(const TArray<FCrossServerDamageRecord>& Records) = 0;
+};
@@ -0,0 +1,63 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Characters/Components/MetaDataComponent.h"
+#include "ProjectilePoolSubsystem.generated.h"
+
+class AProjectile;
+class AWeapon;
+
+USTRUCT()
+struct FProjectilePool
+{
+	GENERATED_BODY()
+
+	// Deactivated projectiles waiting to be fired again.
+	UPROPERTY()
+	TArray<AProjectile*> Inactive;
+
+	// Number of projectiles to have ready when the match starts.
+	int32 WarmCount = 0;
+};
+
+/**
+ * Per-class pool of projectiles, used by the authoritative worker to avoid spawning and destroying an actor per shot.
+ * Pooled projectiles are hidden rather than destroyed, so clients keep their replicated instance and reuse it too.
+ */
+UCLASS()
+class GDKSHOOTER_API UProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// [server] Declares that projectiles of this class will be fired, so the pool can be warmed at match start.
+	void RegisterProjectileClass(TSubclassOf<AProjectile> ProjectileClass, int32 WarmCount);
+
+	// [server] Fills every registered pool up to its warm count.
+	void WarmPools();
+
+	// [server] Returns a live projectile at the given transform, reusing a pooled one when possible.
+	AProjectile* AcquireProjectile(TSubclassOf<AProjectile> ProjectileClass, const FTransform& SpawnTransform, AWeapon* InstigatingWeapon, const FGDKMetaData& MetaData);
+
+	// [server] Deactivates a projectile and keeps it for reuse, destroying it instead if its pool is full.
+	void ReleaseProjectile(AProjectile* Projectile);
+
+private:
+	AProjectile* SpawnPooledProjectile(TSubclassOf<AProjectile> ProjectileClass, const FTransform& SpawnTransform);
+
+	void UpdatePoolStats();
+
+	// Upper bound on inactive projectiles kept per class.
+	int32 MaxPooledPerClass = 64;
+
+	UPROPERTY()
+	TMap<UClass*, FProjectilePool> Pools;
+
+	uint32 TotalAcquires = 0;
+	uint32 TotalPoolHits = 0;
+};
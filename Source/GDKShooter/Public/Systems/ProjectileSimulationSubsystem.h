@@ -0,0 +1,89 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ProjectileSimulationSubsystem.generated.h"
+
+class AProjectile;
+class AProjectileWeapon;
+class UDamageType;
+
+// Movement and damage settings shared by every simulated projectile of one AProjectile class, read from its CDO.
+struct FSimulatedProjectileArchetype
+{
+	float Radius = 0.5f;
+	float GravityScale = 1.0f;
+	float MaxSpeed = 0.0f;
+	bool bShouldBounce = false;
+	float Bounciness = 0.6f;
+	float Friction = 0.2f;
+	float BounceVelocityStopThreshold = 5.0f;
+
+	bool bExplodeOnStop = true;
+	int32 MaximumBounces = -1;
+	float LifeTillExplode = 5.0f;
+
+	float ExplosionDamage = 50.0f;
+	float ExplosionMinimumDamage = 10.0f;
+	float ExplosionRadius = 500.0f;
+	float ExplosionInnerRadius = 100.0f;
+	float ExplosionFalloff = 1.0f;
+	TSubclassOf<UDamageType> DamageTypeClass;
+};
+
+/**
+ * Simulates projectiles without an actor each, keeping in-flight state in contiguous arrays and sweeping them all in one pass per frame.
+ * The server applies damage, clients simulate the same projectiles locally from a spawn event for visuals only.
+ */
+UCLASS()
+class GDKSHOOTER_API UProjectileSimulationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+	// Launches a projectile with the movement and damage settings of ProjectileClass.
+	// Damage is only applied when bAuthoritative; VisualClass, if set, is spawned locally and follows the projectile.
+	// There is no projectile actor to pass as DamageCauser, so Weapon is passed instead, as instant weapons do.
+	void SpawnProjectile(TSubclassOf<AProjectile> ProjectileClass, const FVector& Origin, const FVector& Direction, AProjectileWeapon* Weapon, bool bAuthoritative, TSubclassOf<AActor> VisualClass = nullptr);
+
+	int32 GetNumProjectiles() const { return Positions.Num(); }
+
+private:
+	uint16 FindOrAddArchetype(TSubclassOf<AProjectile> ProjectileClass);
+
+	// Mirrors AProjectile::OnStop: explodes with point damage to the stopping actor if the archetype explodes on stop, otherwise rests.
+	void StopProjectile(int32 Index, const FHitResult& StopHit);
+
+	void Explode(int32 Index, const FHitResult* StopHit);
+
+	void RemoveProjectile(int32 Index);
+
+	TArray<FSimulatedProjectileArchetype> Archetypes;
+	TMap<UClass*, uint16> ArchetypeIndices;
+
+	// Hot per-projectile state, one entry per live projectile at the same index in every array.
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> Lifetimes;
+	TArray<int32> Bounces;
+	TArray<uint16> ArchetypeIds;
+
+	// Cold per-projectile state, only read on spawn, hit and explosion.
+	TArray<TWeakObjectPtr<AProjectileWeapon>> Weapons;
+	TArray<TWeakObjectPtr<AActor>> IgnoredActors;
+	TArray<TWeakObjectPtr<AController>> InstigatingControllers;
+	TArray<TWeakObjectPtr<AActor>> VisualActors;
+	TArray<bool> Authoritative;
+};
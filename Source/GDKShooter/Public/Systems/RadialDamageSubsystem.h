@@ -0,0 +1,74 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "RadialDamageSubsystem.generated.h"
+
+class AActor;
+class UDamageType;
+class UHealthComponent;
+struct FRadialDamageEvent;
+
+/**
+ * Applies explosion damage to the actors registered by UHealthComponent, using a uniform spatial hash instead of a physics overlap.
+ * Damage is delivered through AActor::TakeDamage with an FRadialDamageEvent, exactly once per victim.
+ * Actors that take damage without registering, such as ACrossServerPawn or Blueprints handling AnyDamage, are still found
+ * with the engine's overlap, as in UGameplayStatics::ApplyRadialDamageWithFalloff.
+ */
+UCLASS()
+class GDKSHOOTER_API URadialDamageSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	void RegisterDamageable(UHealthComponent* HealthComponent);
+	void UnregisterDamageable(UHealthComponent* HealthComponent);
+
+	// Actors made of many damageable pieces without a UHealthComponent each, such as ABuildableManager.
+	// They receive every explosion that reaches their bounds, with no component hits, and work out which of their pieces it reaches themselves.
+	void RegisterInstancedDamageable(AActor* Actor);
+	void UnregisterInstancedDamageable(AActor* Actor);
+
+	// Drop-in replacement for UGameplayStatics::ApplyRadialDamageWithFalloff, falling back to it if the subsystem is unavailable.
+	static bool ApplyRadialDamageWithFalloff(const UObject* WorldContextObject, float BaseDamage, float MinimumDamage, const FVector& Origin, float DamageInnerRadius, float DamageOuterRadius, float DamageFalloff, TSubclassOf<UDamageType> DamageTypeClass, const TArray<AActor*>& IgnoreActors, AActor* DamageCauser = nullptr, AController* InstigatedByController = nullptr, ECollisionChannel DamagePreventionChannel = ECC_Visibility);
+
+	bool ApplyRadialDamage(float BaseDamage, float MinimumDamage, const FVector& Origin, float DamageInnerRadius, float DamageOuterRadius, float DamageFalloff, TSubclassOf<UDamageType> DamageTypeClass, const TArray<AActor*>& IgnoreActors, AActor* DamageCauser, AController* InstigatedByController, ECollisionChannel DamagePreventionChannel);
+
+private:
+	void RebuildSpatialHashIfStale();
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	// UGameplayStatics::ApplyRadialDamageWithFalloff restricted to actors that are not registered. Returns whether any took damage.
+	bool ApplyToUnregisteredActors(const FRadialDamageEvent& DmgEvent, float BaseDamage, const TArray<AActor*>& IgnoreActors, AActor* DamageCauser, AController* InstigatedByController, ECollisionChannel DamagePreventionChannel);
+
+	// Edge length of a spatial hash cell, roughly the radius of a typical explosion.
+	float CellSize = 1000.0f;
+
+	TArray<TWeakObjectPtr<UHealthComponent>> Damageables;
+	TMap<UHealthComponent*, int32> DamageableIndices;
+
+	TArray<TWeakObjectPtr<AActor>> InstancedDamageables;
+
+	// Rebuilt at most once per frame, the first time damage is applied.
+	TMap<FIntVector, TArray<int32>> Cells;
+	TArray<FBox> Bounds;
+	float MaxBoundsExtent = 0.0f;
+
+	// Components bounding box of each of InstancedDamageables.
+	TArray<FBox> InstancedBounds;
+
+	// Owners of Damageables and the instanced damageables, skipped by the overlap for unregistered actors.
+	TSet<const AActor*> RegisteredActors;
+	uint64 LastRebuildFrame = MAX_uint64;
+
+	// Scratch buffers reused between explosions.
+	TArray<int32> Candidates;
+	TArray<float> DistancesSquared;
+	TArray<FOverlapResult> Overlaps;
+};
@@ -0,0 +1,66 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "RegenerationSubsystem.generated.h"
+
+class UHealthComponent;
+
+// Regeneration settings of one health component, copied when it registers or is damaged.
+struct FRegenerationRates
+{
+	float HealthValue = 0.0f;
+	float HealthCooldown = 0.0f;
+	float HealthInterval = 0.0f;
+
+	float ArmourValue = 0.0f;
+	float ArmourCooldown = 0.0f;
+	float ArmourInterval = 0.0f;
+};
+
+/**
+ * Regenerates health and armour for every registered UHealthComponent in one batched update at a fixed rate,
+ * instead of each component re-arming its own timers whenever it takes damage.
+ * Damage only stamps when the next regeneration is due; state is kept in dense arrays indexed per component.
+ */
+UCLASS()
+class GDKSHOOTER_API URegenerationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+	// [server]
+	void RegisterRegeneration(UHealthComponent* HealthComponent, const FRegenerationRates& Rates);
+	void UnregisterRegeneration(UHealthComponent* HealthComponent);
+
+	// [server] Postpones regeneration until the cooldowns have elapsed from now.
+	void NotifyDamaged(UHealthComponent* HealthComponent, const FRegenerationRates& Rates);
+
+private:
+	void RemoveAt(int32 Index);
+
+	// Time between batched updates.
+	float UpdateInterval = 0.1f;
+	float TimeSinceUpdate = 0.0f;
+
+	TArray<TWeakObjectPtr<UHealthComponent>> Components;
+	TArray<FRegenerationRates> Rates;
+
+	// World time at which the next regeneration is due, MAX_flt until the component is first damaged.
+	TArray<float> NextHealthTimes;
+	TArray<float> NextArmourTimes;
+
+	TMap<UHealthComponent*, int32> ComponentIndices;
+};
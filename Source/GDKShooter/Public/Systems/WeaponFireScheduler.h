@@ -0,0 +1,54 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WeaponFireScheduler.generated.h"
+
+class AWeapon;
+
+/**
+ * Wakes weapons up at their next fire or buffered-shot expiry time, so weapons don't have to tick every frame.
+ * Entries are kept in a min-heap and are never removed early: a weapon invalidates its older entries by rescheduling.
+ */
+UCLASS()
+class GDKSHOOTER_API UWeaponFireScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+	// Calls AWeapon::ProcessScheduledFire with Generation on the first frame at or after FireTime (in real time seconds).
+	void ScheduleFire(AWeapon* Weapon, float FireTime, uint32 Generation);
+
+private:
+	struct FScheduledFire
+	{
+		float FireTime;
+		TWeakObjectPtr<AWeapon> Weapon;
+		uint32 Generation;
+	};
+
+	struct FScheduledFirePredicate
+	{
+		bool operator()(const FScheduledFire& A, const FScheduledFire& B) const
+		{
+			return A.FireTime < B.FireTime;
+		}
+	};
+
+	TArray<FScheduledFire> Heap;
+
+	// Entries due this frame, dispatched after popping so that rescheduling lands in a later frame.
+	TArray<FScheduledFire> Due;
+};
@@ -0,0 +1,27 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+// Object channel used by lightweight hit proxies on pawns and vehicles. See DefaultEngine.ini.
+#define ECC_Hitbox ECC_GameTraceChannel1
+
+// Trace channel used for weapon hitscan. Blocked by hitboxes and world geometry, ignored by pawn capsules and meshes.
+#define ECC_WeaponTrace ECC_GameTraceChannel2
+
+class UPrimitiveComponent;
+class UShapeComponent;
+
+namespace HitboxCollision
+{
+	// Collision profile applied to hit proxies.
+	GDKSHOOTER_API extern const FName ProfileName;
+
+	// Configures a shape component as a query-only hit proxy that only responds to ECC_WeaponTrace.
+	GDKSHOOTER_API void ConfigureHitbox(UShapeComponent* Shape);
+
+	// Stops a component from being hit by weapon traces, so that only its owner's hitboxes are considered.
+	GDKSHOOTER_API void IgnoreWeaponTraces(UPrimitiveComponent* Component);
+}
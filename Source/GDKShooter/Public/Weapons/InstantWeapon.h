@@ -3,14 +3,19 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Weapons/InstantWeaponPolicies.h"
+#include "Weapons/ShotRateLimiter.h"
 #include "Weapons/Weapon.h"
 #include "Runtime/Engine/Public/TimerManager.h"
 #include "InstantWeapon.generated.h"
 
+class AInstantWeapon;
+using FInstantFireFunction = void (AInstantWeapon::*)();
+
 /**
  * AInstantWeapon implements hitscan shooting for a single-shot, burst-fire, or full-auto weapon.
  * Hit detection is entirely client-side, with loose server validation.
- * Shot timing and rate-limiting is entirely client-side, with no server validation.
+ * Shot timing is client-side, the server drops shots arriving faster than the weapon's fire rate allows.
  */
 UCLASS(Abstract, Blueprintable, SpatialType)
 class GDKSHOOTER_API AInstantWeapon : public AWeapon
@@ -20,6 +25,8 @@ class GDKSHOOTER_API AInstantWeapon : public AWeapon
 public:
 	AInstantWeapon();
 
+	virtual void BeginPlay() override;
+
 	virtual void StartPrimaryUse_Implementation() override;
 	virtual void StopPrimaryUse_Implementation() override;
 
@@ -46,8 +53,32 @@ protected:
 
 	virtual FVector GetLineTraceDirection() override;
 
+	// [server] Applied to validated hits. Subclasses pick a different policy in their constructor.
+	FInstantDamagePolicyFunction DamagePolicy;
+
 private:
 
+	// Selects the FireShot instantiation matching this weapon's burst and spread settings.
+	void BindFirePolicies();
+
+	template<typename SpreadPolicy>
+	void BindFireMode();
+
+	// [client] Traces and reports one shot, then advances the burst as FireModePolicy dictates.
+	template<typename FireModePolicy, typename SpreadPolicy>
+	void FireShot();
+
+	FInstantFireFunction FireFunction = nullptr;
+
+	// Spread at 100m for the current aiming and crouching state.
+	float GetCurrentSpread();
+
+	// [client] Reports a single traced shot to the server and plays local effects.
+	void ProcessShot(const FInstantHitInfo& HitInfo);
+
+	// [client] Receives the results of a multi-pellet shot traced through UShootingComponent::DoLineTraceBatch.
+	void OnPelletTracesCompleted(const TArray<FInstantHitInfo>& HitInfos);
+
 	// [server] Notifies clients of a hit.
 	void NotifyClientsOfHit(const FInstantHitInfo& HitInfo, bool bImpact);
 
@@ -60,6 +91,12 @@ private:
 	// [server] Actually deals damage to the actor we hit.
 	void DealDamage(const FInstantHitInfo& HitInfo);
 
+	// [server] Returns false if this shot exceeds the weapon's fire rate and should be dropped.
+	bool ConsumeShotToken();
+
+	// [server] Sizes the token bucket from the weapon's shot timing.
+	void ConfigureRateLimiter();
+
 	// [client] Clears the NextShotTimer if it's running.
 	void ClearTimerIfRunning();
 
@@ -97,6 +134,10 @@ private:
 	// >1 = burst fire
 	UPROPERTY(EditAnywhere, Category = "Weapons")
 	int32 BurstCount;
+
+	// Number of rays traced per shot, each with its own spread. Values above 1 make a shotgun-style weapon.
+	UPROPERTY(EditAnywhere, Category = "Weapons", meta = (ClampMin = "1"))
+	int32 PelletsPerShot = 1;
 	
 	// Time of the next allowed burst, based on last burst start + burst interval.
 	float NextBurstTime;
@@ -128,4 +169,15 @@ private:
 
 	UPROPERTY(EditAnywhere, Category = "Weapons")
 		float SpreadCrouchModifier = 0.5f;
+
+	// Fraction above the nominal fire rate the server accepts, to absorb network jitter.
+	UPROPERTY(EditAnywhere, Category = "Weapons|Validation", meta = (ClampMin = "0"))
+	float RateLimitJitterTolerance = 0.25f;
+
+	// Extra shots the server lets a client bank, for RPCs that arrive bunched together.
+	UPROPERTY(EditAnywhere, Category = "Weapons|Validation", meta = (ClampMin = "0"))
+	int32 RateLimitBurstAllowance = 2;
+
+	// [server] Token bucket of shots, one token per pellet.
+	FShotRateLimiter ShotRateLimiter;
 };
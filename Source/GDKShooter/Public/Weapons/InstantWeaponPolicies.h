@@ -0,0 +1,103 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Characters/Components/ShootingComponent.h"
+#include "GameFramework/DamageType.h"
+
+/**
+ * Compile-time policies for AInstantWeapon's firing path.
+ * The weapon binds one instantiation of AInstantWeapon::FireShot<FireMode, Spread> when it begins play,
+ * so the per-shot path has no runtime branching on burst settings or spread.
+ */
+
+// Fire mode policies: how a shot advances the burst.
+
+// Fires for as long as the trigger is held.
+struct FAutomaticFireMode
+{
+	static constexpr bool bCountsBurst = false;
+	static constexpr bool bSingleShot = false;
+	static constexpr bool bRepeatsBurst = false;
+};
+
+// One shot per trigger pull.
+struct FSingleShotFireMode
+{
+	static constexpr bool bCountsBurst = false;
+	static constexpr bool bSingleShot = true;
+	static constexpr bool bRepeatsBurst = false;
+};
+
+// BurstCount shots per trigger pull.
+struct FBurstFireMode
+{
+	static constexpr bool bCountsBurst = true;
+	static constexpr bool bSingleShot = false;
+	static constexpr bool bRepeatsBurst = false;
+};
+
+// BurstCount shots, repeated every BurstInterval for as long as the trigger is held.
+struct FContinuousBurstFireMode
+{
+	static constexpr bool bCountsBurst = true;
+	static constexpr bool bSingleShot = false;
+	static constexpr bool bRepeatsBurst = true;
+};
+
+// Spread policies: how the aim direction is perturbed.
+
+// Weapons with no spread configured skip the movement state queries entirely.
+struct FNoSpread
+{
+	static constexpr bool bUsesSpread = false;
+
+	static FORCEINLINE FVector Apply(const FVector& AimDirection, float SpreadAt100m)
+	{
+		return AimDirection;
+	}
+};
+
+// Uniform random point in a circle whose radius is the spread at 100m.
+struct FCircleSpread
+{
+	static constexpr bool bUsesSpread = true;
+
+	static FORCEINLINE FVector Apply(const FVector& AimDirection, float SpreadAt100m)
+	{
+		if (SpreadAt100m <= 0)
+		{
+			return AimDirection;
+		}
+
+		const FVector2D Spread = FMath::RandPointInCircle(SpreadAt100m);
+		return AimDirection.Rotation().RotateVector(FVector(10000, Spread.X, Spread.Y));
+	}
+};
+
+// Damage policies: what a validated hit does on the server.
+
+struct FInstantDamageParams
+{
+	float BaseDamage;
+	TSubclassOf<UDamageType> DamageTypeClass;
+	AController* Instigator;
+	AActor* DamageCauser;
+};
+
+// Regular weapon damage through AActor::TakeDamage.
+struct GDKSHOOTER_API FPointDamagePolicy
+{
+	static void Apply(const FInstantHitInfo& HitInfo, const FInstantDamageParams& Params);
+};
+
+// Repairs buildables instead of damaging anything.
+struct GDKSHOOTER_API FBuildRepairDamagePolicy
+{
+	static constexpr float RepairPerShot = 25.0f;
+
+	static void Apply(const FInstantHitInfo& HitInfo, const FInstantDamageParams& Params);
+};
+
+using FInstantDamagePolicyFunction = void(*)(const FInstantHitInfo& HitInfo, const FInstantDamageParams& Params);
@@ -6,9 +6,26 @@
 #include "GameFramework/Actor.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "Systems/ProjectileSimulationSubsystem.h"
 #include "Weapons/Weapon.h"
 #include "Projectile.generated.h"
 
+// Position and velocity of a projectile at a point in server time, from which clients extrapolate its flight.
+USTRUCT()
+struct FProjectileFlightState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize100 Location;
+
+	UPROPERTY()
+	FVector_NetQuantize100 Velocity;
+
+	UPROPERTY()
+	float ServerTime = 0.0f;
+};
+
 UCLASS(Abstract, Blueprintable)
 class GDKSHOOTER_API AProjectile : public AActor
 {
@@ -19,12 +36,25 @@ public:
 
 	virtual void PostInitializeComponents() override;
 
+	virtual void BeginPlay() override;
+
 	virtual void Tick(float DeltaTime) override;
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	void SetPlayer(AWeapon* Weapon);
 
+	// [server] Reactivates a pooled projectile as if it had just been spawned at the given transform.
+	void ResetForReuse(const FTransform& SpawnTransform);
+
+	// [server] Hides and stops the projectile so it can sit in UProjectilePoolSubsystem until fired again.
+	void DeactivateForPool();
+
+	// Movement and damage settings used when this class is simulated by UProjectileSimulationSubsystem instead of spawned.
+	FSimulatedProjectileArchetype MakeSimulationArchetype() const;
+
+	float GetInitialSpeed() const { return MovementComp->InitialSpeed; }
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_MetaData)
 	FGDKMetaData MetaData;
 
@@ -85,6 +115,55 @@ protected:
 	UFUNCTION()
 	void OnRep_Exploded();
 
+	// Set while the projectile sits in UProjectilePoolSubsystem. Kept apart from bExploded so that
+	// warm-spawned projectiles, which never exploded, don't play explosion visuals on clients.
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_Pooled)
+	bool bPooled;
+
+	UFUNCTION()
+	void OnRep_Pooled();
+
+	// Replicate only the launch state and occasional corrections instead of streaming movement.
+	// Clients simulate the flight locally from the launch state.
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	bool bReplicateSpawnParams = false;
+
+	UPROPERTY(ReplicatedUsing = OnRep_LaunchState)
+	FProjectileFlightState LaunchState;
+
+	// [server] Set when the server's flight diverges from what clients can predict, on bounce and on explosion.
+	UPROPERTY(ReplicatedUsing = OnRep_Correction)
+	FProjectileFlightState Correction;
+
+	UFUNCTION()
+	void OnRep_LaunchState();
+
+	UFUNCTION()
+	void OnRep_Correction();
+
+	// [server] Captures the current location and velocity as the launch state.
+	void RecordLaunch();
+
+	// [server] Captures the current location and velocity as a correction.
+	void RecordCorrection();
+
+	// [client] Moves the projectile to where the given state puts it now, assuming a ballistic flight since then.
+	void ApplyFlightState(const FProjectileFlightState& State);
+
+	float GetServerWorldTime() const;
+
+	// Restores visuals and movement after an explosion, when the projectile is reused.
+	void ResetSimulation();
+
+	// [server] Hands the projectile back to the pool once explosion visuals have played out.
+	void ReturnToPool();
+
+	// Time after exploding before the projectile is pooled, so clients see the explosion.
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	float ReturnToPoolDelay = 2.0f;
+
+	FTimerHandle ReturnToPoolTimer;
+
 	UFUNCTION(BlueprintNativeEvent)
 	void ExplosionVisuals();
 
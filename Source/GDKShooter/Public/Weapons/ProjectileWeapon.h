@@ -16,6 +16,11 @@ class GDKSHOOTER_API AProjectileWeapon : public AWeapon
 
 public:
 	AProjectileWeapon();
+
+	virtual void BeginPlay() override;
+
+	// Called on every worker simulating a projectile fired by this weapon when it explodes.
+	void OnSimulatedProjectileExploded(const FVector& Location) { OnProjectileExploded(Location); }
 	
 protected:
 	virtual void DoFire_Implementation() override;
@@ -23,6 +28,10 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Weapons")
 	void OnShot();
 
+	// Explosion visuals for projectiles simulated by UProjectileSimulationSubsystem, which have no actor of their own.
+	UFUNCTION(BlueprintImplementableEvent, Category = "Weapons")
+	void OnProjectileExploded(FVector Location);
+
 	// Minimum time between shots in seconds.
 	UPROPERTY(EditAnywhere, Category = "Weapons")
 	float ShotCooldown;
@@ -34,6 +43,19 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapons")
 	TSubclassOf<class AProjectile> ProjectileClass;
 
+	// Number of projectiles of ProjectileClass to have pooled and ready when the match starts.
+	UPROPERTY(EditAnywhere, Category = "Weapons")
+	int32 PoolWarmCount = 8;
+
+	// Simulate projectiles in UProjectileSimulationSubsystem instead of spawning a replicated actor per shot.
+	// ProjectileClass still provides the movement and damage settings.
+	UPROPERTY(EditAnywhere, Category = "Weapons")
+	bool bUseProjectileSimulation = false;
+
+	// Optional non-replicated actor spawned locally to represent each simulated projectile.
+	UPROPERTY(EditAnywhere, Category = "Weapons", meta = (EditCondition = "bUseProjectileSimulation"))
+	TSubclassOf<AActor> ProjectileVisualClass;
+
 	// Socket name of where to spawn projectiles
 	UPROPERTY(EditAnywhere, Category = "Weapons")
 	FName BarrelSocket = FName(TEXT("WP_Barrel"));
@@ -41,5 +63,9 @@ protected:
 	UFUNCTION(reliable, server, WithValidation)
 	void FireProjectile(FVector Origin, FVector_NetQuantizeNormal Direction);
 
+	// [server] Tells clients to simulate a projectile locally.
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileSpawned(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction);
+
 	virtual void ConsumeBufferedShot() override;
 };
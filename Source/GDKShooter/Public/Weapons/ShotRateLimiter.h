@@ -0,0 +1,54 @@
+// Copyright (c) Improbable Worlds Ltd, All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Token bucket used by the server to reject shots arriving faster than a weapon can fire.
+ * Tokens refill continuously at TokensPerSecond up to Capacity, and each shot consumes one.
+ */
+struct FShotRateLimiter
+{
+	// A non-positive rate disables limiting.
+	void Configure(float InTokensPerSecond, float InCapacity)
+	{
+		TokensPerSecond = InTokensPerSecond;
+		Capacity = FMath::Max(InCapacity, 1.0f);
+		Tokens = Capacity;
+		LastRefillTime = -1.0f;
+		bConfigured = true;
+	}
+
+	bool IsConfigured() const { return bConfigured; }
+
+	// Returns false, without consuming anything, if there are not enough tokens for this shot.
+	bool TryConsume(float Now, float Cost = 1.0f)
+	{
+		if (TokensPerSecond <= 0.0f)
+		{
+			return true;
+		}
+
+		if (LastRefillTime >= 0.0f)
+		{
+			Tokens = FMath::Min(Capacity, Tokens + FMath::Max(Now - LastRefillTime, 0.0f) * TokensPerSecond);
+		}
+		LastRefillTime = Now;
+
+		if (Tokens < Cost)
+		{
+			return false;
+		}
+
+		Tokens -= Cost;
+		return true;
+	}
+
+private:
+	float TokensPerSecond = 0.0f;
+	float Capacity = 1.0f;
+	float Tokens = 1.0f;
+	float LastRefillTime = -1.0f;
+	bool bConfigured = false;
+};
@@ -20,7 +20,10 @@ class GDKSHOOTER_API AWeapon : public AHoldable
 public:	
 	AWeapon();
 
-	virtual void Tick(float DeltaTime) override;
+	virtual void BeginPlay() override;
+
+	// Called by UWeaponFireScheduler when a shot or buffered shot expiry is due. Stale generations are ignored.
+	void ProcessScheduledFire(uint32 Generation);
 
 	virtual void StartSecondaryUse_Implementation() override;
 	virtual void StopSecondaryUse_Implementation() override;
@@ -107,6 +110,9 @@ protected:
 	bool BufferedShotStillValid();
 	virtual void ConsumeBufferedShot();
 
+	// Schedules the next wake-up with UWeaponFireScheduler if the trigger is held or a shot is buffered.
+	void RescheduleFire();
+
 private:
 	UPROPERTY()
 	AActor* CachedOwner;
@@ -119,4 +125,7 @@ private:
 
 	UFUNCTION()
 	void RefreshComponentCache();
+
+	// Incremented on every reschedule, invalidating entries already queued in UWeaponFireScheduler.
+	uint32 FireScheduleGeneration = 0;
 };
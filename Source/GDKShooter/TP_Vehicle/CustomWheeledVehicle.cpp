@@ -15,8 +15,10 @@
 #include "Engine/Engine.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Components/TextRenderComponent.h"
+#include "Components/BoxComponent.h"
 #include "Materials/Material.h"
 #include "GameFramework/Controller.h"
+#include "Weapons/HitboxCollision.h"
 #include "RepMovComponent.h"
 
 #ifndef HMD_MODULE_INCLUDED
@@ -118,6 +120,12 @@ ACustomWheeledVehicle::ACustomWheeledVehicle()
 	InCarGear->SetRelativeScale3D(FVector(1.0f, 0.4f, 0.4f));
 	InCarGear->SetupAttachment(GetMesh());
 
+	// Weapon traces hit this box instead of the skeletal mesh's physics asset
+	Hitbox = CreateDefaultSubobject<UBoxComponent>(TEXT("Hitbox"));
+	Hitbox->SetupAttachment(GetMesh());
+	HitboxCollision::ConfigureHitbox(Hitbox);
+	HitboxCollision::IgnoreWeaponTraces(GetMesh());
+
 	// Colors for the incar gear display. One for normal one for reverse
 	GearDisplayReverseColor = FColor(255, 0, 0, 255);
 	GearDisplayColor = FColor(255, 255, 255, 255);
@@ -231,6 +239,11 @@ void ACustomWheeledVehicle::Tick(float Delta)
 void ACustomWheeledVehicle::BeginPlay()
 {
 	Super::BeginPlay();
+
+	const FBoxSphereBounds LocalBounds = GetMesh()->CalcBounds(FTransform::Identity);
+	Hitbox->SetRelativeLocation(LocalBounds.Origin);
+	Hitbox->SetBoxExtent(LocalBounds.BoxExtent);
+
 	bool bEnableInCar = false;
 #if HMD_MODULE_INCLUDED
 	bEnableInCar = UHeadMountedDisplayFunctionLibrary::IsHeadMountedDisplayEnabled();
@@ -44,6 +44,10 @@ class GDKSHOOTER_API ACustomWheeledVehicle : public AWheeledVehicle
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 		UTextRenderComponent* InCarGear;
 
+	/** Simplified box hit proxy used by weapon traces, sized to the vehicle mesh on BeginPlay */
+	UPROPERTY(Category = Vehicle, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UBoxComponent* Hitbox;
+
 	/** vehicle simulation component */
 	UPROPERTY(Category = Vehicle, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	class URepMovComponent* RepMovementComponent;
@@ -43,6 +43,10 @@ class ATP_VehiclePawn : public AWheeledVehicle
 	UPROPERTY(Category = Display, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	UTextRenderComponent* InCarGear;
 
+	/** Simplified box hit proxy used by weapon traces, sized to the vehicle mesh on BeginPlay */
+	UPROPERTY(Category = Vehicle, VisibleDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UBoxComponent* Hitbox;
+
 	
 public:
 	ATP_VehiclePawn();